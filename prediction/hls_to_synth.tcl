@@ -3,8 +3,12 @@ set_working_dir .
 solution file add ./src/fetch.h
 solution file add ./src/drim4hls.h
 solution file add ./src/top.cpp
+solution file add ./src/memory.h
 solution file add ./src/writeback.h
 solution file add ./src/execute.h
+solution file add ./src/divider.h
+solution file add ./src/multiplier.h
+solution file add ./src/regfile.h
 solution file add ./src/decode.h
 solution file set ./src/top.cpp -exclude true
 go compile
@@ -21,53 +25,132 @@ directive set -CLOCKS {clk {-CLOCK_PERIOD 10 -CLOCK_HIGH_TIME 5 -CLOCK_OFFSET 0.
 go assembly
 directive set /drim4hls/fetch/fetch_th/ra_stack.valid:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/ra_stack.pc:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/fetch/fetch_th/ra_stack_dec.valid:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/fetch/fetch_th/ra_stack_dec.pc:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/icache_buffer_addr:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/icache_buffer_instr:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/fetch/fetch_th/prefetch_buffer_addr:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/fetch/fetch_th/prefetch_buffer_instr:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/icache_tags.tag:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/icache_tags.valid:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/fetch/fetch_th/icache_repl:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/cache_data.data:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/cache_tag.tag:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/cache_tag.valid:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/btb_data.tag:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/btb_data.bta:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/btb_data.prediction_data:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/fetch/fetch_th/btb_data.valid:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/icache_data.data:rsc -MAP_TO_MODULE ram_nangate-45nm-dualport_beh.RAM_dualRW
 directive set /drim4hls/fetch/fetch_th/icache_data.data:rsc -GEN_EXTERNAL_ENABLE true
 directive set /drim4hls/fetch/fetch_th/icache_data.data:rsc -INTERLEAVE 2
 directive set /drim4hls/decode/sentinel.rom:rsc -MAP_TO_MODULE {[Register]}
-directive set /drim4hls/decode/decode_th/regfile:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/decode/decode_th/regfile.copy:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/decode/decode_th/regfile.lvt:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/decode/decode_th/regfile.conflicts:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/decode/decode_th/sentinel:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/execute/csr.rom:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/execute/execute_th/csr:rsc -MAP_TO_MODULE {[Register]}
-directive set /drim4hls/writeback/writeback_th/dcache_data.data:rsc -INTERLEAVE 2
-directive set /drim4hls/writeback/writeback_th/dcache_tags.tag:rsc -MAP_TO_MODULE {[Register]}
-directive set /drim4hls/writeback/writeback_th/dcache_tags.valid:rsc -MAP_TO_MODULE {[Register]}
-directive set /drim4hls/writeback/writeback_th/dcache_tags.dirty:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/dcache_data.data:rsc -INTERLEAVE 2
+directive set /drim4hls/memory/memory_th/dcache_tags.tag:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/dcache_tags.valid:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/dcache_tags.dirty:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/dcache_tags.prefetched:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/dcache_repl:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/store_buffer_addr:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/store_buffer_data:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/store_buffer_mask:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/last_set_data.data:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_addr:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_line:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_words:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_offset:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_load:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_done:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_ld:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_byte_index:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_dest:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_tag:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_data:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_mask:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/victim_buffer_addr:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/victim_buffer_data:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/mshr_prefetch:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/rpt_pc:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/rpt_addr:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/rpt_stride:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/memory/memory_th/rpt_confidence:rsc -MAP_TO_MODULE {[Register]}
 directive set /drim4hls/fetch/fetch_th/FETCH_BODY:for -UNROLL yes
 directive set /drim4hls/fetch/fetch_th/FETCH_BODY:for:for -UNROLL yes
 directive set /drim4hls/fetch/fetch_th/fetch::icache:for -UNROLL yes
 directive set /drim4hls/fetch/fetch_th/FETCH_BODY:for#1 -UNROLL yes
 directive set /drim4hls/fetch/fetch_th/FETCH_BODY:if#1:for -UNROLL yes
 directive set /drim4hls/fetch/fetch_th/FETCH_BODY:if#1:for:for -UNROLL yes
-directive set /drim4hls/fetch/fetch_th/fetch::icache_write:for -UNROLL yes
-directive set /drim4hls/writeback/writeback_th/writeback::dcache:for -UNROLL yes
-directive set /drim4hls/writeback/writeback_th/writeback::dcache_write:for -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::icache_victim:for -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::icache_victim:for#1 -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::icache_touch:for -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::icache_refill:for -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::icache_refill:for#1 -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::icache_refill:for#2 -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::imem_collect:for -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::imem_collect:for#1 -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::icache_install:for -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::prefetch_fill:for -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::prefetch_lookup:for -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::prefetch_issue:for -UNROLL yes
+directive set /drim4hls/fetch/fetch_th/fetch::prefetch_issue:for#1 -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::dcache:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::dcache_write:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::store_buffer_forward:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::store_buffer_forward:for:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::store_buffer_update:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::store_buffer_update:for#1 -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::amo_write:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::amo_write:for#1 -UNROLL yes
+directive set /drim4hls/divider/divider_th/divider::udiv_func:for -UNROLL yes
+directive set /drim4hls/multiplier/multiplier_th/stage_acc:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/multiplier/multiplier_th/stage_a:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/multiplier/multiplier_th/stage_b:rsc -MAP_TO_MODULE {[Register]}
+directive set /drim4hls/multiplier/multiplier_th/multiplier::stage_advance:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::mshr_allocate:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::mshr_fill:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::mshr_complete:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::mshr_complete:for#1 -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::mshr_drain:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::mshr_outstanding:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::mshr_report:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::dcache_victim:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::dcache_victim:for#1 -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::dcache_touch:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::dcache_evict:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::victim_buffer_write:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::victim_buffer_restore:for -UNROLL yes
+directive set /drim4hls/memory/memory_th/memory::prefetch_issue:for -UNROLL yes
+directive set /drim4hls/execute/execute_th/execute::perf_count:for -UNROLL yes
+directive set /drim4hls/execute/execute_th/execute::bitmanip:for -UNROLL yes
+directive set /drim4hls/execute/execute_th/execute::bitmanip:for#1 -UNROLL yes
+directive set /drim4hls/execute/execute_th/execute::bitmanip:for#2 -UNROLL yes
+directive set /drim4hls/execute/execute_th/execute::bitmanip:for#3 -UNROLL yes
+directive set /drim4hls/execute/execute_th/execute::bitmanip:for#4 -UNROLL yes
+directive set /drim4hls/decode/decode_th/regfile_t::read:for -UNROLL yes
+directive set /drim4hls/decode/decode_th/regfile_t::reads_fit:for -UNROLL yes
+directive set /drim4hls/decode/decode_th/regfile_t::reads_fit:for:for -UNROLL yes
 go architect
 ignore_memory_precedences -from /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(0).@) -to /drim4hls/fetch/fetch_th/fetch::fetch:write_mem(icache_data.data:rsc(0)(0).@)#1
 ignore_memory_precedences -from /drim4hls/fetch/fetch_th/fetch::fetch:write_mem(icache_data.data:rsc(0)(0).@)#1 -to /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(0).@)
-ignore_memory_precedences -from /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(0).@) -to /drim4hls/fetch/fetch_th/fetch::icache_write:for:write_mem(icache_data.data:rsc(0)(0).@)
-ignore_memory_precedences -from /drim4hls/fetch/fetch_th/fetch::icache_write:for:write_mem(icache_data.data:rsc(0)(0).@) -to /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(0).@)
-ignore_memory_precedences -from /drim4hls/writeback/writeback_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(0).@) -to /drim4hls/writeback/writeback_th/writeback::writeback:write_mem(dcache_data.data:rsc(0)(0).@)#1
-ignore_memory_precedences -from /drim4hls/writeback/writeback_th/writeback::writeback:write_mem(dcache_data.data:rsc(0)(0).@)#1 -to /drim4hls/writeback/writeback_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(0).@)
-ignore_memory_precedences -from /drim4hls/writeback/writeback_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(0).@) -to /drim4hls/writeback/writeback_th/dcache_data_t::operator=#3:write_mem(dcache_data.data:rsc(0)(0).@)
-ignore_memory_precedences -from /drim4hls/writeback/writeback_th/dcache_data_t::operator=#3:write_mem(dcache_data.data:rsc(0)(0).@) -to /drim4hls/writeback/writeback_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(0).@)
-ignore_memory_precedences -from /drim4hls/writeback/writeback_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(1).@)#1 -to /drim4hls/writeback/writeback_th/writeback::writeback:write_mem(dcache_data.data:rsc(0)(1).@)
-ignore_memory_precedences -from /drim4hls/writeback/writeback_th/writeback::writeback:write_mem(dcache_data.data:rsc(0)(1).@) -to /drim4hls/writeback/writeback_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(1).@)#1
-ignore_memory_precedences -from /drim4hls/writeback/writeback_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(1).@)#1 -to /drim4hls/writeback/writeback_th/dcache_data_t::operator=#3:write_mem(dcache_data.data:rsc(0)(1).@)#1
-ignore_memory_precedences -from /drim4hls/writeback/writeback_th/dcache_data_t::operator=#3:write_mem(dcache_data.data:rsc(0)(1).@)#1 -to /drim4hls/writeback/writeback_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(1).@)#1
+ignore_memory_precedences -from /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(0).@) -to /drim4hls/fetch/fetch_th/fetch::icache_install:write_mem(icache_data.data:rsc(0)(0).@)
+ignore_memory_precedences -from /drim4hls/fetch/fetch_th/fetch::icache_install:write_mem(icache_data.data:rsc(0)(0).@) -to /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(0).@)
+ignore_memory_precedences -from /drim4hls/memory/memory_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(0).@) -to /drim4hls/memory/memory_th/memory::memory:write_mem(dcache_data.data:rsc(0)(0).@)#1
+ignore_memory_precedences -from /drim4hls/memory/memory_th/memory::memory:write_mem(dcache_data.data:rsc(0)(0).@)#1 -to /drim4hls/memory/memory_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(0).@)
+ignore_memory_precedences -from /drim4hls/memory/memory_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(0).@) -to /drim4hls/memory/memory_th/dcache_data_t::operator=#3:write_mem(dcache_data.data:rsc(0)(0).@)
+ignore_memory_precedences -from /drim4hls/memory/memory_th/dcache_data_t::operator=#3:write_mem(dcache_data.data:rsc(0)(0).@) -to /drim4hls/memory/memory_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(0).@)
+ignore_memory_precedences -from /drim4hls/memory/memory_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(1).@)#1 -to /drim4hls/memory/memory_th/memory::memory:write_mem(dcache_data.data:rsc(0)(1).@)
+ignore_memory_precedences -from /drim4hls/memory/memory_th/memory::memory:write_mem(dcache_data.data:rsc(0)(1).@) -to /drim4hls/memory/memory_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(1).@)#1
+ignore_memory_precedences -from /drim4hls/memory/memory_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(1).@)#1 -to /drim4hls/memory/memory_th/dcache_data_t::operator=#3:write_mem(dcache_data.data:rsc(0)(1).@)#1
+ignore_memory_precedences -from /drim4hls/memory/memory_th/dcache_data_t::operator=#3:write_mem(dcache_data.data:rsc(0)(1).@)#1 -to /drim4hls/memory/memory_th/dcache_data_t::operator=:read_mem(dcache_data.data:rsc(0)(1).@)#1
 ignore_memory_precedences -from /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(1).@)#1 -to /drim4hls/fetch/fetch_th/fetch::fetch:write_mem(icache_data.data:rsc(0)(1).@)
 ignore_memory_precedences -from /drim4hls/fetch/fetch_th/fetch::fetch:write_mem(icache_data.data:rsc(0)(1).@) -to /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(1).@)#1
-ignore_memory_precedences -from /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(1).@)#1 -to /drim4hls/fetch/fetch_th/fetch::icache_write:for:write_mem(icache_data.data:rsc(0)(1).@)#1
-ignore_memory_precedences -from /drim4hls/fetch/fetch_th/fetch::icache_write:for:write_mem(icache_data.data:rsc(0)(1).@)#1 -to /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(1).@)#1
+ignore_memory_precedences -from /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(1).@)#1 -to /drim4hls/fetch/fetch_th/fetch::icache_install:write_mem(icache_data.data:rsc(0)(1).@)#1
+ignore_memory_precedences -from /drim4hls/fetch/fetch_th/fetch::icache_install:write_mem(icache_data.data:rsc(0)(1).@)#1 -to /drim4hls/fetch/fetch_th/icache_data_t::operator=:read_mem(icache_data.data:rsc(0)(1).@)#1
 go allocate
 go extract
\ No newline at end of file
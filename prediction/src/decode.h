@@ -25,6 +25,7 @@
 #include "drim4hls_datatypes.h"
 #include "defines.h"
 #include "globals.h"
+#include "regfile.h"
 
 #include <mc_connections.h>
 
@@ -39,6 +40,7 @@ SC_MODULE(decode) {
     Connections::In < mem_out_t > CCS_INIT_S1(feed_from_wb);
     Connections::In < fe_out_t > CCS_INIT_S1(fetch_din);
     Connections::In < reg_forward_t > CCS_INIT_S1(fwd_exe);
+    Connections::In < reg_forward_t > CCS_INIT_S1(fwd_mem);
     
     // End of simulation signal.
     sc_out < bool > CCS_INIT_S1(program_end);
@@ -64,21 +66,35 @@ SC_MODULE(decode) {
     bool forward_success_rs1;
     bool forward_success_rs2;
 
-    bool load_instruction;
-    sc_int < PC_LEN > load_pc;
-
     sc_uint < INSN_LEN > insn; // Contains full instruction fetched from IMEM. Used in decoding.
     sc_int < PC_LEN > pc; // Contains PC for the current instruction that is decoded   
     // NB. x0 is included in this regfile so it is not a real hardcoded 0
     // constant. The writeback section of fedec has a guard fro writes on
     // x0. For double protection, some instructions that want to write into
     // x0 will have their regwrite signal forced to false.
-    sc_uint < XLEN > regfile[REG_NUM];
+    regfile_t regfile;
     // Keeps track of in-flight instructions that are going to overwrite a
     // register. Implements a primitive stall mechanism for RAW hazards.
-    sc_uint < XLEN + 1 > sentinel[REG_NUM];
-
-    sc_uint < TAG_WIDTH > tag;
+    // Bits [TAG_WIDTH:1] hold the tag of the youngest writer, bit 0 is the valid bit.
+    sc_uint < TAG_WIDTH + 1 > sentinel[REG_NUM];
+    // One bit per register, set when its youngest in-flight writer is a load.
+    // Tells load-use stalls apart for the performance monitor.
+    sc_uint < REG_NUM > sentinel_ld;
+
+    sc_uint < TAG_WIDTH > tag; // Tag of the next instruction sent to execute
+    // One bit per tag, set while a load with that tag waits for a D$ miss or a
+    // division for the divider. Such a tag is not handed out again until the
+    // instruction has written back.
+    sc_uint < TAG_NUM > tag_pending;
+    bool late_write; // The late load result in feedinput goes into the register file
+    // A division is in the divider. The next one waits until its result is back,
+    // so the divider is free whenever execute hands it one.
+    bool div_inflight;
+    #ifdef MUL_UNIT
+    // Multiplications whose result is not back yet. At most MUL_INFLIGHT, which
+    // the multiplier and its result buffer can always hold.
+    sc_uint < TAG_WIDTH > mul_inflight;
+    #endif
     // Stalls processor and sends a nop operation to the execute stage
     sc_uint < OPCODE_SIZE > opcode;
 
@@ -93,8 +109,30 @@ SC_MODULE(decode) {
 
     reg_forward_t fwd;
     reg_forward_t temp_fwd;
+    reg_forward_t fwd_m; // ALU result of the instruction in the memory stage
 
     fe_out_t fetch_in; // Buffer for the data coming from the fetch stage
+    sc_uint < PC_LEN > pred_pc; // Next pc predicted by fetch for the current instruction
+    bool second_slot; // The second instruction of fetch_in is still to be decoded
+    sc_uint < 1 > rvc; // The current instruction was expanded from a compressed one
+    #ifdef FUSION
+    // The current instruction is the second of a fused pair. The first one only
+    // supplies an operand: the upper immediate, or the shifted source.
+    sc_uint < 2 > fused;
+    sc_uint < XLEN > fuse_value; // Result of the LUI/AUIPC
+    sc_uint < 2 > fuse_shift; // Shift amount of the SLLI
+    sc_uint < REG_ADDR > fuse_rs1; // Source of the SLLI
+    sc_uint < REG_ADDR > fuse_rs2; // Other source of the ADD
+    #endif
+    #ifdef DUAL_ISSUE
+    // The second instruction of the pair, decoded for the ALU lane of execute
+    bool lane1; // It only needs the ALU
+    bool lane1_rs1; // Its first operand is a register, otherwise lane1_base
+    bool lane1_rs2; // Its second operand is a register, otherwise lane1_imm
+    sc_uint < ALUOP_SIZE > lane1_op;
+    sc_uint < XLEN > lane1_base;
+    sc_uint < XLEN > lane1_imm;
+    #endif
 
     unsigned int imem_data; // Contains instruction data
    
@@ -104,12 +142,13 @@ SC_MODULE(decode) {
      
     bool flush_next;
     bool new_instr;
+    // Instructions that fetch queued before the last redirect carry the old
+    // epoch and are turned into bubbles.
+    bool wrong_path;
+    sc_uint < 1 > epoch;
     int position_fwd;
+    int position_mem;
     int position_wb;
-    
-    sc_uint < DCACHE_INDEX_WIDTH > last_ldst_index;
-    sc_uint < DCACHE_INDEX_WIDTH > last_ldst_index_temp;
-    bool last_ldst_valid;
      
     SC_CTOR(decode): clk("clk"),
     rst("rst"),
@@ -119,6 +158,7 @@ SC_MODULE(decode) {
     fetch_dout("fetch_dout"),
     program_end("program_end"),
     fwd_exe("fwd_exe"),
+    fwd_mem("fwd_mem"),
     icount("icount"),
     j_icount("j_icount"),
     b_icount("b_icount"),
@@ -164,11 +204,21 @@ SC_MODULE(decode) {
             feed_from_wb.Reset();
             fetch_dout.Reset();
             fwd_exe.Reset();
+            fwd_mem.Reset();
 			//fetch_dout.write(fetch_out);
             // Init. sentinel flags to zero.
             for (int i = 0; i < REG_NUM; i++) {
                 sentinel[i] = SENTINEL_INIT;
             }
+            sentinel_ld = 0;
+            regfile.reset();
+            tag = 0;
+            tag_pending = 0;
+            late_write = false;
+            div_inflight = false;
+            #ifdef MUL_UNIT
+            mul_inflight = 0;
+            #endif
 
             // Program has not completed
             program_end.write(false);
@@ -193,16 +243,32 @@ SC_MODULE(decode) {
             branch = false;
             jump = false;
             pc = -4;
-            load_instruction = false;
-            load_pc = -4;
             new_instr = false;
             position_fwd = 0;
+            position_mem = 0;
             position_wb = 0;
             fetch_out.address = 0;
-
-			last_ldst_valid = false;
-			last_ldst_index = 0;
-			last_ldst_index_temp = 0;
+            fetch_out.redirect = false;
+            wrong_path = false;
+            epoch = 0;
+            pred_pc = 0;
+            second_slot = false;
+            rvc = 0;
+            #ifdef DUAL_ISSUE
+            lane1 = false;
+            lane1_rs1 = false;
+            lane1_rs2 = false;
+            lane1_op = ALUOP_NULL;
+            lane1_base = 0;
+            lane1_imm = 0;
+            #endif
+            #ifdef FUSION
+            fused = FUSE_NONE;
+            fuse_value = 0;
+            fuse_shift = 0;
+            fuse_rs1 = 0;
+            fuse_rs2 = 0;
+            #endif
 
             wait();
         }
@@ -213,10 +279,41 @@ SC_MODULE(decode) {
             // Retrieve data from instruction memory and fetch stage.
             // If processor stalls then just clear the channels from new data.
 			
+			bool fetch_popped = false;
 			if (!freeze) {
-				fetch_in = fetch_din.Pop();
-				pc = fetch_in.pc;
-				imem_data = fetch_in.instr_data;
+				#ifdef FUSION
+				fused = FUSE_NONE;
+				#endif
+				if (!second_slot) {
+					fetch_in = fetch_din.Pop();
+					fetch_popped = true;
+					pc = fetch_in.pc;
+					imem_data = fetch_in.instr_data;
+					pred_pc = fetch_in.pred_pc;
+					rvc = fetch_in.rvc;
+					second_slot = fetch_in.valid_1;
+					#ifdef FUSION
+					if (fetch_in.valid_1) {
+						fused = fusion(fetch_in.instr_data, fetch_in.instr_data_1);
+					}
+					if (fused != FUSE_NONE) {
+						// The pair goes on as its second instruction
+						pc = fetch_in.pc + (fetch_in.rvc == 1 ? 2 : 4);
+						imem_data = fetch_in.instr_data_1;
+						pred_pc = fetch_in.pred_pc_1;
+						rvc = fetch_in.rvc_1;
+						second_slot = false;
+					}
+					#endif
+				} else {
+					// Second instruction of a fetched pair, nothing to pop.
+					pc = fetch_in.pc + (fetch_in.rvc == 1 ? 2 : 4);
+					imem_data = fetch_in.instr_data_1;
+					pred_pc = fetch_in.pred_pc_1;
+					rvc = fetch_in.rvc_1;
+					second_slot = false;
+				}
+				wrong_path = (fetch_in.epoch != epoch);
 			}
 			
     
@@ -226,24 +323,56 @@ SC_MODULE(decode) {
 				position_fwd = 1;
 			}
 			
-			if (position_wb == 2) {
+			if (position_mem == 2) {
+				fwd_m = fwd_mem.Pop();
+			}else {
+				position_mem++;
+			}
+			
+			bool wb_popped = false;
+			if (position_wb == 3) {
 				feedinput = feed_from_wb.Pop();
-				
-				if (feedinput.pc == load_pc && load_instruction) {
-                    load_instruction = false;
-                }
+				wb_popped = true;
 			}else {
 				position_wb++;
 			}
 
-            if (feedinput.regwrite == 1 && feedinput.regfile_address != 0) { // Actual writeback.
-                    regfile[feedinput.regfile_address] = feedinput.regfile_data; // Overwrite register.
-
-				if ((feedinput.pc == sentinel[feedinput.regfile_address].range(32,1)) && (sentinel[feedinput.regfile_address][0] == 1)) {
+            if (feedinput.regwrite == 1 && feedinput.regfile_address != 0) {
+				if ((feedinput.tag == sentinel[feedinput.regfile_address].range(TAG_WIDTH, 1)) && (sentinel[feedinput.regfile_address][0] == 1)) {
 					sentinel[feedinput.regfile_address][0] = 0;
 				}
 
             }
+            #ifdef DUAL_ISSUE
+            if (feedinput.regwrite_1 == 1 && feedinput.regfile_address_1 != 0) {
+				if ((feedinput.tag_1 == sentinel[feedinput.regfile_address_1].range(TAG_WIDTH, 1)) && (sentinel[feedinput.regfile_address_1][0] == 1)) {
+					sentinel[feedinput.regfile_address_1][0] = 0;
+				}
+            }
+            #endif
+            
+            // A load that missed in the D$, or a division, writes back out of order
+            // through the late fields. The value only lands if no younger instruction has claimed the
+            // register in the meantime.
+            if (feedinput.miss == 1) {
+                tag_pending[feedinput.tag] = 1;
+            }
+            late_write = false;
+            if (feedinput.late_regwrite == 1) {
+                tag_pending[feedinput.late_tag] = 0;
+                if (feedinput.late_unit == UNIT_DIV) {
+                    div_inflight = false;
+                }
+                #ifdef MUL_UNIT
+                if (feedinput.late_unit == UNIT_MUL) {
+                    mul_inflight--;
+                }
+                #endif
+                if (feedinput.late_regfile_address != 0 && (feedinput.late_tag == sentinel[feedinput.late_regfile_address].range(TAG_WIDTH, 1)) && (sentinel[feedinput.late_regfile_address][0] == 1)) {
+                    sentinel[feedinput.late_regfile_address][0] = 0;
+                    late_write = true;
+                }
+            }
 
             flush_next = false;
             new_instr = false;
@@ -260,62 +389,103 @@ SC_MODULE(decode) {
             #endif
 
             output.pc = pc;
+            output.rvc = rvc;
             fetch_out.pc = pc;
-            // Increment some instruction counters
-            //opcode = sc_uint < OPCODE_SIZE > (sc_bv < OPCODE_SIZE > (insn.range(6, 2)));
-			opcode = insn.range(6, 2);
-
-            if (opcode == OPC_LW || opcode == OPC_SW) {
-                // Increment memory instruction counter
-				m_icount.write(m_icount.read() + 1);
-			}
-            else if (opcode == OPC_JAL || opcode == OPC_JALR) {
-				// Increment jump instruction counter
-                j_icount.write(j_icount.read() + 1);
-			} else if (opcode == OPC_BEQ) {
-				// Increment branch instruction counter
-				b_icount.write(b_icount.read() + 1);
-            } else {
-				// Increment other instruction counter
-                o_icount.write(o_icount.read() + 1);
-			}
-            icount.write(icount.read() + 1);
+            fetch_out.rvc = rvc;
             
             freeze_tmp = false;
 
-           if (insn == 0x0000006f) {
+           if (insn == 0x0000006f && !wrong_path) {
                 // jump to yourself (end of program).
                 program_end.write(true);
             }
 
             sc_uint < REG_ADDR > rs1_addr = insn.range(19, 15);
             sc_uint < REG_ADDR > rs2_addr = insn.range(24, 20);
+            #ifdef FUSION
+            // The sources of a fused pair are those of the pair, not of its second
+            // instruction: none for the upper immediate, the SLLI's for the shift.
+            if (fused == FUSE_UPPER) {
+                rs1_addr = 0;
+            } else if (fused == FUSE_SHIFT) {
+                rs1_addr = fuse_rs1;
+                rs2_addr = fuse_rs2;
+            }
+            #endif
 			
 			
-			sc_uint< 32 > rs1_sent_pc = sentinel[rs1_addr].range(32, 1);
+			// Operand selection, youngest source first: the execute result of the previous
+			// instruction, the ALU result in the memory stage, the result written back in
+			// this cycle, a late load result, then the register file.
+			sc_uint < TAG_WIDTH > rs1_sent_tag = sentinel[rs1_addr].range(TAG_WIDTH, 1);
 			sc_uint < 1 > rs1_sent_valid = sentinel[rs1_addr].range(0, 0);
             
-            if (!fwd.ldst && fwd.pc == rs1_sent_pc && rs1_sent_valid == 1) {
+            if (!fwd.ldst && fwd.tag == rs1_sent_tag && rs1_sent_valid == 1) {
                 forward_success_rs1 = true;
                 output.rs1 = fwd.regfile_data;
                 #ifndef __SYNTHESIS__
                 debug_dout_t.rs1 = fwd.regfile_data;
                 debug_dout_t.rs1_forward = forward_success_rs1;
                 #endif
+            #ifdef DUAL_ISSUE
+            } else if (fwd.valid_1 && fwd.tag_1 == rs1_sent_tag && rs1_sent_valid == 1) {
+                forward_success_rs1 = true;
+                output.rs1 = fwd.regfile_data_1;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs1 = fwd.regfile_data_1;
+                debug_dout_t.rs1_forward = forward_success_rs1;
+                #endif
+            #endif
+            } else if (!fwd_m.ldst && fwd_m.tag == rs1_sent_tag && rs1_sent_valid == 1) {
+                forward_success_rs1 = true;
+                output.rs1 = fwd_m.regfile_data;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs1 = fwd_m.regfile_data;
+                debug_dout_t.rs1_forward = forward_success_rs1;
+                #endif
+            #ifdef DUAL_ISSUE
+            } else if (fwd_m.valid_1 && fwd_m.tag_1 == rs1_sent_tag && rs1_sent_valid == 1) {
+                forward_success_rs1 = true;
+                output.rs1 = fwd_m.regfile_data_1;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs1 = fwd_m.regfile_data_1;
+                debug_dout_t.rs1_forward = forward_success_rs1;
+                #endif
+            } else if (feedinput.regwrite_1 == 1 && feedinput.regfile_address_1 == rs1_addr && rs1_addr != 0) {
+                output.rs1 = feedinput.regfile_data_1;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs1 = feedinput.regfile_data_1;
+                debug_dout_t.rs1_forward = forward_success_rs1;
+                #endif
+            #endif
+            } else if (feedinput.regwrite == 1 && feedinput.regfile_address == rs1_addr && rs1_addr != 0) {
+                // Bypass of the value written back in this cycle, load results included,
+                // so that it does not have to go through the register file first.
+                output.rs1 = feedinput.regfile_data;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs1 = feedinput.regfile_data;
+                debug_dout_t.rs1_forward = forward_success_rs1;
+                #endif
+            } else if (late_write && feedinput.late_regfile_address == rs1_addr) {
+                output.rs1 = feedinput.late_regfile_data;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs1 = feedinput.late_regfile_data;
+                debug_dout_t.rs1_forward = forward_success_rs1;
+                #endif
             } else if (!forward_success_rs1) {
         
-                output.rs1 = regfile[rs1_addr];
+                output.rs1 = regfile.read(rs1_addr);
                 #ifndef __SYNTHESIS__
-                debug_dout_t.rs1 = regfile[rs1_addr];
+                debug_dout_t.rs1 = regfile.read(rs1_addr);
                 debug_dout_t.rs1_forward = forward_success_rs1;
                 #endif
      
             }
 
-            sc_uint < 32 > rs2_sent_pc = sentinel[rs2_addr].range(32, 1);
+            sc_uint < TAG_WIDTH > rs2_sent_tag = sentinel[rs2_addr].range(TAG_WIDTH, 1);
 			sc_uint < 1 > rs2_sent_valid = sentinel[rs2_addr].range(0, 0);
 			
-            if (!fwd.ldst && fwd.pc == rs2_sent_pc && rs2_sent_valid == 1) {
+            if (!fwd.ldst && fwd.tag == rs2_sent_tag && rs2_sent_valid == 1) {
                 forward_success_rs2 = true;
                 output.rs2 = fwd.regfile_data;
 				#ifndef __SYNTHESIS__
@@ -323,16 +493,91 @@ SC_MODULE(decode) {
                 debug_dout_t.rs2_forward = forward_success_rs2;
                 #endif
 
+            #ifdef DUAL_ISSUE
+            } else if (fwd.valid_1 && fwd.tag_1 == rs2_sent_tag && rs2_sent_valid == 1) {
+                forward_success_rs2 = true;
+                output.rs2 = fwd.regfile_data_1;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs2 = fwd.regfile_data_1;
+                debug_dout_t.rs2_forward = forward_success_rs2;
+                #endif
+            #endif
+            } else if (!fwd_m.ldst && fwd_m.tag == rs2_sent_tag && rs2_sent_valid == 1) {
+                forward_success_rs2 = true;
+                output.rs2 = fwd_m.regfile_data;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs2 = fwd_m.regfile_data;
+                debug_dout_t.rs2_forward = forward_success_rs2;
+                #endif
+            #ifdef DUAL_ISSUE
+            } else if (fwd_m.valid_1 && fwd_m.tag_1 == rs2_sent_tag && rs2_sent_valid == 1) {
+                forward_success_rs2 = true;
+                output.rs2 = fwd_m.regfile_data_1;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs2 = fwd_m.regfile_data_1;
+                debug_dout_t.rs2_forward = forward_success_rs2;
+                #endif
+            } else if (feedinput.regwrite_1 == 1 && feedinput.regfile_address_1 == rs2_addr && rs2_addr != 0) {
+                output.rs2 = feedinput.regfile_data_1;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs2 = feedinput.regfile_data_1;
+                debug_dout_t.rs2_forward = forward_success_rs2;
+                #endif
+            #endif
+            } else if (feedinput.regwrite == 1 && feedinput.regfile_address == rs2_addr && rs2_addr != 0) {
+                // Bypass of the value written back in this cycle, load results included,
+                // so that it does not have to go through the register file first.
+                output.rs2 = feedinput.regfile_data;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs2 = feedinput.regfile_data;
+                debug_dout_t.rs2_forward = forward_success_rs2;
+                #endif
+            } else if (late_write && feedinput.late_regfile_address == rs2_addr) {
+                output.rs2 = feedinput.late_regfile_data;
+                #ifndef __SYNTHESIS__
+                debug_dout_t.rs2 = feedinput.late_regfile_data;
+                debug_dout_t.rs2_forward = forward_success_rs2;
+                #endif
             } else if (!forward_success_rs2) {
                 
-                output.rs2 = regfile[rs2_addr];
+                output.rs2 = regfile.read(rs2_addr);
                 #ifndef __SYNTHESIS__
-                debug_dout_t.rs2 = regfile[rs2_addr];
+                debug_dout_t.rs2 = regfile.read(rs2_addr);
                 debug_dout_t.rs2_forward = forward_success_rs2;
                 #endif
 
             
             }
+            
+            #ifdef DUAL_ISSUE
+            // Operands of the second instruction of the pair, for the ALU lane
+            sc_uint < INSN_LEN > insn_1 = fetch_in.instr_data_1;
+            bool lane1_ready_rs1 = true;
+            bool lane1_ready_rs2 = true;
+            lane1 = second_slot && lane1_decode(insn_1);
+            output.rs1_1 = lane1_rs1 ? lane1_operand(insn_1.range(19, 15), lane1_ready_rs1) : (sc_int < XLEN >) lane1_base;
+            output.rs2_1 = lane1_rs2 ? lane1_operand(insn_1.range(24, 20), lane1_ready_rs2) : (sc_int < XLEN >) lane1_imm;
+            #endif
+            
+            #ifdef FUSION
+            if (fused == FUSE_UPPER) {
+                output.rs1 = fuse_value;
+            } else if (fused == FUSE_SHIFT) {
+                output.rs1 = (sc_uint < XLEN >) output.rs1 << fuse_shift;
+            }
+            #endif
+            
+            if (late_write) {
+                regfile.write(REGFILE_WP_LATE, feedinput.late_regfile_address, feedinput.late_regfile_data);
+            }
+            if (feedinput.regwrite == 1 && feedinput.regfile_address != 0) { // Actual writeback.
+                regfile.write(REGFILE_WP_WB, feedinput.regfile_address, feedinput.regfile_data); // Overwrite register.
+            }
+            #ifdef DUAL_ISSUE
+            if (feedinput.regwrite_1 == 1 && feedinput.regfile_address_1 != 0) { // Result of the ALU lane, never the same register.
+                regfile.write(REGFILE_WP_WB_1, feedinput.regfile_address_1, feedinput.regfile_data_1);
+            }
+            #endif
 
             // *** Feedback to fetch data computation and put() section.
             // -- Address sign extensions.
@@ -344,7 +589,8 @@ SC_MODULE(decode) {
             fetch_out.branch_taken = false;
             fetch_out.btb_update = false;
             fetch_out.ras_update = false;
-            fetch_out.address = pc + 4;
+            fetch_out.ras_pop = false;
+            fetch_out.address = pc + (rvc == 1 ? 2 : 4);
             jump = false;
             
             if (insn.range(6, 2) == OPC_JAL) {
@@ -365,6 +611,7 @@ SC_MODULE(decode) {
                 self_feed.jump_address[0] = 0;
                 
                 jump = true;
+                fetch_out.ras_pop = true;
 
                 fetch_out.bta = self_feed.jump_address;
                 fetch_out.address = self_feed.jump_address;
@@ -460,6 +707,7 @@ SC_MODULE(decode) {
             // *** END of RD propagation and immediates sign extensions.
 
             // *** Control word generation.
+            output.amo = AMO_NONE;
             switch (insn.range(6, 2)) { // Opcode's 2 LSBs have been trimmed to save area.
 
             case OPC_LUI:
@@ -605,7 +853,7 @@ SC_MODULE(decode) {
                     #ifndef __SYNTHESIS__
                     debug_dout_t.ld = "NO_LOAD";
                     #endif
-                    SC_REPORT_ERROR(sc_object::name(), "Unimplemented LOAD instruction");
+                    if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented LOAD instruction");
                     break;
                 }
                 output.alu_op = ALUOP_ADD;
@@ -650,7 +898,7 @@ SC_MODULE(decode) {
                     #ifndef __SYNTHESIS__
                     debug_dout_t.st = "NO_STORE";
                     #endif
-                    SC_REPORT_ERROR(sc_object::name(), "Unimplemented STORE instruction");
+                    if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented STORE instruction");
                     break;
                 }
                 output.alu_op = ALUOP_ADD;
@@ -696,6 +944,17 @@ SC_MODULE(decode) {
                     debug_dout_t.alu_op = "ALUOP_SRLI";
                     debug_dout_t.alu_src = "ALUSRC_IMM_U";
                     #endif
+                #ifdef BITMANIP
+                } else if (bitmanip_imm(insn) != ALUOP_NULL) {
+                    // Shift amount or unary operation, taken from the low bits of the immediate
+                    output.alu_op = bitmanip_imm(insn);
+                    output.alu_src = ALUSRC_IMM_I;
+
+                    #ifndef __SYNTHESIS__
+                    debug_dout_t.alu_op = "ALUOP_BITMANIP";
+                    debug_dout_t.alu_src = "ALUSRC_IMM_I";
+                    #endif
+                #endif
                 } else {
                     output.alu_src = ALUSRC_IMM_I;
 
@@ -751,7 +1010,7 @@ SC_MODULE(decode) {
                         #ifndef __SYNTHESIS__
                         debug_dout_t.alu_op = "ALUOP_NULL";
                         #endif
-                        SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP_IMM instruction");
+                        if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP_IMM instruction");
                         break;
                     }
                 }
@@ -852,7 +1111,7 @@ SC_MODULE(decode) {
                         #ifndef __SYNTHESIS__
                         debug_dout_t.alu_op = "ALUOP_NULL";
                         #endif
-                        SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP_ADD instruction");
+                        if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP_ADD instruction");
                         break;
                     }
                     break;
@@ -872,13 +1131,36 @@ SC_MODULE(decode) {
                         debug_dout_t.alu_op = "ALUOP_SRA";
                         #endif
                         break;
+                        #ifdef BITMANIP
+                    case FUNCT3_AND:
+                        output.alu_op = ALUOP_ANDN;
+
+                        #ifndef __SYNTHESIS__
+                        debug_dout_t.alu_op = "ALUOP_ANDN";
+                        #endif
+                        break;
+                    case FUNCT3_OR:
+                        output.alu_op = ALUOP_ORN;
+
+                        #ifndef __SYNTHESIS__
+                        debug_dout_t.alu_op = "ALUOP_ORN";
+                        #endif
+                        break;
+                    case FUNCT3_XOR:
+                        output.alu_op = ALUOP_XNOR;
+
+                        #ifndef __SYNTHESIS__
+                        debug_dout_t.alu_op = "ALUOP_XNOR";
+                        #endif
+                        break;
+                        #endif
                     default:
                         output.alu_op = ALUOP_NULL;
 
                         #ifndef __SYNTHESIS__
                         debug_dout_t.alu_op = "ALUOP_NULL";
                         #endif
-                        SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP_SUB instruction");
+                        if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP_SUB instruction");
                         break;
                     }
                     break;
@@ -947,18 +1229,60 @@ SC_MODULE(decode) {
                         #ifndef __SYNTHESIS__
                         debug_dout_t.alu_op = "ALUOP_NULL";
                         #endif
-                        SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP_MUL instruction");
+                        if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP_MUL instruction");
                         break;
                     }
                     break;
                     #endif
+                    #ifdef ZICOND
+                case FUNCT7_CZERO:
+                    if (insn.range(14, 12) == FUNCT3_CZEROEQZ) {
+                        output.alu_op = ALUOP_CZEROEQZ;
+
+                        #ifndef __SYNTHESIS__
+                        debug_dout_t.alu_op = "ALUOP_CZEROEQZ";
+                        #endif
+                    } else if (insn.range(14, 12) == FUNCT3_CZERONEZ) {
+                        output.alu_op = ALUOP_CZERONEZ;
+
+                        #ifndef __SYNTHESIS__
+                        debug_dout_t.alu_op = "ALUOP_CZERONEZ";
+                        #endif
+                    } else {
+                        output.alu_op = ALUOP_NULL;
+
+                        #ifndef __SYNTHESIS__
+                        debug_dout_t.alu_op = "ALUOP_NULL";
+                        #endif
+                        if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented CZERO instruction");
+                    }
+                    break;
+                    #endif
+                    #ifdef BITMANIP
+                case FUNCT7_SHADD: // SH1ADD, SH2ADD, SH3ADD
+                case FUNCT7_MINMAX: // MIN, MINU, MAX, MAXU
+                case FUNCT7_ZEXTH: // ZEXT.H
+                case FUNCT7_ROT: // ROL, ROR
+                case FUNCT7_BCLR: // BCLR, BEXT
+                case FUNCT7_BINV: // BINV
+                case FUNCT7_BSET: // BSET
+                    output.alu_op = bitmanip_reg(insn);
+
+                    #ifndef __SYNTHESIS__
+                    debug_dout_t.alu_op = "ALUOP_BITMANIP";
+                    #endif
+                    if (output.alu_op == ALUOP_NULL) {
+                        if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented bit-manipulation instruction");
+                    }
+                    break;
+                    #endif
                 default:
                     output.alu_op = ALUOP_NULL;
 
                     #ifndef __SYNTHESIS__
                     debug_dout_t.alu_op = "ALUOP_NULL";
                     #endif
-                    SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP instruction");
+                    if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented ALUOP instruction");
                     break;
                 }
                 break;
@@ -1073,12 +1397,60 @@ SC_MODULE(decode) {
                     #ifndef __SYNTHESIS__
                     debug_dout_t.alu_op = "ALUOP_NULL";
                     #endif
-                    SC_REPORT_ERROR(sc_object::name(), "Unimplemented SYSTEM instruction");
+                    if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented SYSTEM instruction");
                     break;
                 }
                 break;
                 #endif // --- End of System instructions decoding
 
+                #ifdef ATOMIC
+            case OPC_AMO: // LR.W, SC.W, AMO*.W: a word load whose result is the old value (or the SC outcome),
+                          // the memory stage does the write.
+                output.amo = insn.range(31, 27);
+                output.alu_op = ALUOP_ADD;
+                output.alu_src = ALUSRC_IMM_I;
+                output.imm_u = 0; // The address is rs1 alone
+                output.regwrite = 1;
+                output.ld = LW_LOAD;
+                output.st = NO_STORE;
+                output.memtoreg = 1;
+                trap = 0;
+                trap_cause = NULL_CAUSE;
+
+                #ifndef __SYNTHESIS__
+                debug_dout_t.alu_op = "ALUOP_ADD";
+                debug_dout_t.alu_src = "ALUSRC_IMM_I";
+                debug_dout_t.regwrite = "REGWRITE YES";
+                debug_dout_t.ld = "LW_LOAD";
+                debug_dout_t.st = "NO_STORE";
+                debug_dout_t.memtoreg = "MEMTOREG YES";
+                #endif
+                
+                switch (insn.range(31, 27)) {
+                case AMO_ADD:
+                case AMO_SWAP:
+                case AMO_LR:
+                case AMO_SC:
+                case AMO_XOR:
+                case AMO_OR:
+                case AMO_AND:
+                case AMO_MIN:
+                case AMO_MAX:
+                case AMO_MINU:
+                case AMO_MAXU:
+                    break;
+                default:
+                    output.amo = AMO_NONE;
+                    if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented AMO instruction");
+                    break;
+                }
+                if (insn.range(14, 12) != FUNCT3_AMOW) {
+                    output.amo = AMO_NONE;
+                    if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented AMO width");
+                }
+                break;
+                #endif
+
             default: // illegal instruction
                 output.alu_src = ALUSRC_RS2;
                 output.regwrite = 0;
@@ -1101,53 +1473,60 @@ SC_MODULE(decode) {
                 debug_dout_t.imm_u.range(7, 3) = (sc_uint<5>)ILL_INSN_CAUSE;
                 #endif
                 
-                SC_REPORT_ERROR(sc_object::name(), "Unimplemented instruction");
+                if (!wrong_path) SC_REPORT_ERROR(sc_object::name(), "Unimplemented instruction");
                 break;
             } // --- END of OPCODE switch
             // *** END of control word generation.
             sc_uint <1> sen1_test = sentinel[rs1_addr].range(0, 0);
             sc_uint <1> sen2_test = sentinel[rs2_addr].range(0, 0);    
             
-            sc_uint <XLEN> curr_temp_rs2 = 0;
-            if (output.alu_src == ALUSRC_RS2) {
-                curr_temp_rs2 = output.rs2;
-
-            } else if (output.alu_src == ALUSRC_IMM_I) {
-                curr_temp_rs2.range(11, 0) = output.imm_u.range(19, 8);
-                if (output.imm_u[19] == 1) {
-					curr_temp_rs2.range(31 ,12) = (sc_uint < 20 >) 1048575;
-				}
-            } else if (output.alu_src == ALUSRC_IMM_S) {
-				curr_temp_rs2.range(4, 0) = output.dest_reg;
-                curr_temp_rs2.range(11 ,5) = output.imm_u.range(19, 13);
-                 if (curr_temp_rs2[11] == 1) {
-					curr_temp_rs2.range(31, 12) = (sc_uint < 20 >) 1048575;
-				}
-
-            } else {
-				curr_temp_rs2.range(11, 0) = (sc_uint < 12 >) 0; 
-				curr_temp_rs2.range(31, 12) = output.imm_u.range(19, 0);
-            }
-            
-            sc_uint < XLEN > last_ldst_addr = (output.rs1 + curr_temp_rs2);
-            last_ldst_index_temp = last_ldst_addr.range(1 + DCACHE_OFFSET_WIDTH + DCACHE_INDEX_WIDTH, 2 + DCACHE_OFFSET_WIDTH);
-            
-            if ((output.ld != NO_LOAD || output.st != NO_STORE) && (last_ldst_index_temp == last_ldst_index) && last_ldst_valid && !freeze) {
-                load_instruction = true;
-                load_pc = pc;
-            }
+            bool div_op = (output.alu_op == ALUOP_DIV || output.alu_op == ALUOP_DIVU || output.alu_op == ALUOP_REM || output.alu_op == ALUOP_REMU) && output.regwrite[0] == 1 && output.dest_reg != 0;
+            #ifdef MUL_UNIT
+            bool mul_op = (output.alu_op == ALUOP_MUL || output.alu_op == ALUOP_MULH || output.alu_op == ALUOP_MULHSU || output.alu_op == ALUOP_MULHU) && output.regwrite[0] == 1 && output.dest_reg != 0;
+            bool mul_full = mul_op && mul_inflight == MUL_INFLIGHT;
+            #else
+            bool mul_full = false;
+            #endif
             
             freeze = false;
-            if (load_instruction || (sen1_test && !forward_success_rs1) || (sen2_test && !forward_success_rs2)) {
+            // Also wait when the next tag still belongs to a load waiting for a D$ miss
+            // or a unit, and when a division or a multiplication finds its unit full.
+            if (!wrong_path && ((sen1_test && !forward_success_rs1) || (sen2_test && !forward_success_rs2) || tag_pending[tag] == 1 || (div_op && div_inflight) || mul_full)) {
 				freeze = true;
 			}  
+            #ifdef DUAL_ISSUE
+            // The second instruction of the pair goes along when it only needs the ALU,
+            // its operands are ready, it neither reads nor writes the register of the
+            // first one, and the first one cannot change the flow. Otherwise it is
+            // decoded on its own in the next cycle.
+            sc_uint < PC_LEN > pc_1 = fetch_in.pc + (fetch_in.rvc == 1 ? 2 : 4);
+            sc_uint < REG_ADDR > rd_1 = insn_1.range(11, 7);
+            sc_uint < TAG_WIDTH > tag_1 = tag + 1;
+            bool writes_0 = output.regwrite[0] == 1 && output.dest_reg != 0;
+            bool hazard_1 = writes_0 && ((lane1_rs1 && insn_1.range(19, 15) == output.dest_reg) ||
+                (lane1_rs2 && insn_1.range(24, 20) == output.dest_reg) || rd_1 == output.dest_reg);
+            bool dual = lane1 && !freeze && !wrong_path && insn != 0 && !jump &&
+                insn.range(6, 2) != OPC_BEQ && insn.range(6, 2) != OPC_SYSTEM &&
+                lane1_ready_rs1 && lane1_ready_rs2 && !hazard_1 && tag_pending[tag_1] == 0 &&
+                fetch_in.pred_pc_1 == pc_1 + (fetch_in.rvc_1 == 1 ? 2 : 4);
+            // Last, the register file must have read ports left for it
+            bool bank_conflict = false;
+            if (dual) {
+                sc_uint < REG_ADDR > read_addr[REGFILE_READS] = {rs1_addr, rs2_addr, insn_1.range(19, 15), insn_1.range(24, 20)};
+                bool read_enable[REGFILE_READS] = {true, true, lane1_rs1, lane1_rs2};
+                bank_conflict = !regfile.reads_fit(read_addr, read_enable);
+                dual = !bank_conflict;
+            }
+            #endif
+            bool load_use = !wrong_path && ((sen1_test && !forward_success_rs1 && sentinel_ld[rs1_addr] == 1) || (sen2_test && !forward_success_rs2 && sentinel_ld[rs2_addr] == 1));
             
             sc_uint < 1 > out_regwrite = output.regwrite;
-            sc_uint < 33 > sen_input;
             
-            if (!freeze && output.regwrite[0] == 1 && output.dest_reg != 0) {
-                sentinel[output.dest_reg].range(XLEN, 1) = pc; // Set corresponding sentinel flag.
+            output.tag = tag;
+            if (!freeze && !wrong_path && output.regwrite[0] == 1 && output.dest_reg != 0) {
+                sentinel[output.dest_reg].range(TAG_WIDTH, 1) = tag; // Set corresponding sentinel flag.
                 sentinel[output.dest_reg][0] = 1;
+                sentinel_ld[output.dest_reg] = (output.ld != NO_LOAD);
 
                 if (output.dest_reg == rs1_addr) {
                     forward_success_rs1 = true;
@@ -1155,15 +1534,53 @@ SC_MODULE(decode) {
                     forward_success_rs2 = true;
                 }
             }
+            // The divider and the multiplier count what they still owe, writeback's late
+            // fields give it back.
+            if (!freeze && !wrong_path && div_op) {
+                div_inflight = true;
+            }
+            #ifdef MUL_UNIT
+            if (!freeze && !wrong_path && mul_op) {
+                mul_inflight++;
+            }
+            #endif
+            #ifdef DUAL_ISSUE
+            output.valid_1 = dual;
+            output.alu_op_1 = lane1_op;
+            output.dest_reg_1 = rd_1;
+            output.tag_1 = tag_1;
+            if (dual && rd_1 != 0) {
+                sentinel[rd_1].range(TAG_WIDTH, 1) = tag_1;
+                sentinel[rd_1][0] = 1;
+                sentinel_ld[rd_1] = 0;
+            }
+            if (dual) {
+                tag = tag + 1;
+                second_slot = false; // Nothing left of the pair
+            }
+            #endif
+            // Every instruction sent to execute gets its own tag, so a tag is unique
+            // among the instructions in flight as long as there are fewer than 2^TAG_WIDTH.
+            if (!freeze && !wrong_path) {
+                tag = tag + 1;
+            }
 
             // *** Transform instruction into nop when freeze is active
-            if (insn == 0 || freeze) {
+            // Fetch runs ahead, so a squashed word may be data or the middle of an
+            // instruction: it is not reported above and raises no trap.
+            if (wrong_path) {
+                trap = 0;
+                trap_cause = NULL_CAUSE;
+            }
+            if (insn == 0 || freeze || wrong_path) {
                 // Bubble.
                 output.regwrite = 0;
                 output.ld = NO_LOAD;
                 output.st = NO_STORE;
+                output.amo = AMO_NONE;
                 output.alu_op = ALUOP_NULL;
                 fetch_out.ras_update = false;
+                fetch_out.ras_pop = false;
 				fetch_out.btb_update = false;
                 #ifndef __SYNTHESIS__
                 debug_dout_t.regwrite = "REGWRITE NO";
@@ -1172,20 +1589,73 @@ SC_MODULE(decode) {
                 #endif
             }
             
-            if (output.ld != NO_LOAD || output.st != NO_STORE) {
-				last_ldst_index = last_ldst_index_temp;
-				last_ldst_valid = true;
-			}else {
-				last_ldst_valid = false;
+            // Fetch runs ahead on its own prediction, so it only has to hear from
+            // decode when that prediction was wrong or the BTB/RAS must be trained;
+            // calls and returns are all reported, to rebuild the RAS on a redirect.
+            // The channel buffers an update for every instruction the fetch queue can
+            // hold, so decode keeps draining the queue while fetch waits on the I$.
+            fetch_out.redirect = (fetch_out.address != pred_pc);
+            if (!freeze && !wrong_path && (fetch_out.redirect || fetch_out.btb_update || fetch_out.ras_update || fetch_out.ras_pop)) {
+				fetch_dout.Push(fetch_out);
+				if (fetch_out.redirect) {
+					epoch = epoch + 1;
+				}
 			}
 			
-            if (!freeze) {
-				fetch_dout.Push(fetch_out);
+			#ifdef FUSION
+			output.fused = (fused != FUSE_NONE);
+			#endif
+			
+            // Increment some instruction counters
+            //opcode = sc_uint < OPCODE_SIZE > (sc_bv < OPCODE_SIZE > (insn.range(6, 2)));
+			opcode = insn.range(6, 2);
+
+            // A fused pair also counts the LUI, AUIPC or SLLI it absorbed, and a pair
+            // issued together its second instruction, as an other instruction.
+            int absorbed = 0;
+            #ifdef FUSION
+            absorbed = (fused != FUSE_NONE) ? 1 : 0;
+            #endif
+            #ifdef DUAL_ISSUE
+            absorbed = dual ? 1 : absorbed;
+            #endif
+
+            if (wrong_path) {
+                // Squashed instructions are not counted.
+            } else if (opcode == OPC_LW || opcode == OPC_SW) {
+                // Increment memory instruction counter
+				m_icount.write(m_icount.read() + 1);
+				o_icount.write(o_icount.read() + absorbed);
+			}
+            else if (opcode == OPC_JAL || opcode == OPC_JALR) {
+				// Increment jump instruction counter
+                j_icount.write(j_icount.read() + 1);
+				o_icount.write(o_icount.read() + absorbed);
+			} else if (opcode == OPC_BEQ) {
+				// Increment branch instruction counter
+				b_icount.write(b_icount.read() + 1);
+            } else {
+				// Increment other instruction counter
+                o_icount.write(o_icount.read() + 1 + absorbed);
 			}
+            if (!wrong_path) {
+                icount.write(icount.read() + 1 + absorbed);
+            }
+			
+			// Events of this cycle, counted in execute
+			output.events = 0;
+			output.events[EV_ICACHE_MISS] = fetch_popped && fetch_in.icache_miss == 1;
+			output.events[EV_DCACHE_MISS] = wb_popped && feedinput.dcache_miss == 1;
+			output.events[EV_MISPREDICT] = !freeze && !wrong_path && fetch_out.redirect;
+			output.events[EV_DECODE_FREEZE] = freeze;
+			output.events[EV_DIV_BUSY] = div_inflight;
+			output.events[EV_LOAD_USE] = load_use;
+			#ifdef DUAL_ISSUE
+			output.events[EV_BANK_CONFLICT] = bank_conflict;
+			#endif
 			dout.Push(output);
 
             #ifndef __SYNTHESIS__
-            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "load_instruction=" << load_instruction << endl);
             DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "insn=" << insn << endl);
             DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "freeze= " << freeze << endl);
             DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "flush= " << flush << endl);
@@ -1205,7 +1675,7 @@ SC_MODULE(decode) {
             for (int i = 0; i < REG_NUM;) {
                 DPRINT(endl);
                 for (int j = 0; j < 8; j++) {
-                    int r = regfile[i].to_int();
+                    int r = regfile.read(i).to_int();
                     DPRINT(" " << std::right << std::setfill(' ') << std::setw(2) << i << ": 0x" << std::hex << std::left << std::setfill(' ') << std::setw(10) << r << std::dec);
                     i++;
                     if (i == REG_NUM)
@@ -1216,6 +1686,9 @@ SC_MODULE(decode) {
                     break;
             }
             DPRINT(endl);
+            for (int b = 0; b < REGFILE_BANKS; b++) {
+                DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "bank " << b << " conflicts= " << regfile.conflicts[b] << endl);
+            }
             #endif
            
             wait();
@@ -1252,6 +1725,231 @@ SC_MODULE(decode) {
 		}
     }
 
+    #ifdef DUAL_ISSUE
+    // Decodes the second instruction of a pair for the ALU lane: register-register
+    // and register-immediate arithmetic, LUI and AUIPC. The immediates and the
+    // pc are turned into operand values here, so the lane only needs the
+    // register-register operations. Returns false for anything else.
+    bool lane1_decode(sc_uint < INSN_LEN > insn_1) {
+        sc_uint < FUNCT3_SIZE > funct3 = insn_1.range(14, 12);
+        sc_uint < FUNCT7_SIZE > funct7 = insn_1.range(31, 25);
+        sc_uint < PC_LEN > pc_1 = fetch_in.pc + (fetch_in.rvc == 1 ? 2 : 4);
+        sc_uint < XLEN > imm_i = 0;
+        imm_i.range(11, 0) = insn_1.range(31, 20);
+        if (insn_1[31] == 1) {
+            imm_i.range(31, 12) = (sc_uint < 20 >) 1048575;
+        }
+        
+        lane1_rs1 = true;
+        lane1_rs2 = false;
+        lane1_base = 0;
+        lane1_imm = imm_i;
+        
+        switch (insn_1.range(6, 2)) {
+        case OPC_ADD:
+            lane1_rs2 = true;
+            #ifdef ZICOND
+            if (funct7 == FUNCT7_CZERO && (funct3 == FUNCT3_CZEROEQZ || funct3 == FUNCT3_CZERONEZ)) {
+                lane1_op = (funct3 == FUNCT3_CZEROEQZ) ? ALUOP_CZEROEQZ : ALUOP_CZERONEZ;
+                return true;
+            }
+            #endif
+            if (funct7 != FUNCT7_ADD && !(funct7 == FUNCT7_SUB && (funct3 == FUNCT3_ADD || funct3 == FUNCT3_SRL))) {
+                return false; // M extension
+            }
+            lane1_op = alu_funct3(funct3, funct7 == FUNCT7_SUB);
+            return true;
+        case OPC_ADDI:
+            if (funct3 == FUNCT3_SLLI || funct3 == FUNCT3_SRLI) {
+                if (funct7 != FUNCT7_SLLI && !(funct3 == FUNCT3_SRLI && funct7 == FUNCT7_SRAI)) {
+                    return false; // Bit manipulation
+                }
+                lane1_imm = insn_1.range(24, 20);
+            }
+            lane1_op = alu_funct3(funct3, funct3 == FUNCT3_SRLI && funct7 == FUNCT7_SRAI);
+            return true;
+        case OPC_LUI:
+        case OPC_AUIPC:
+            lane1_rs1 = false;
+            lane1_op = ALUOP_ADD;
+            lane1_imm = ((sc_uint < 20 >) insn_1.range(31, 12), sc_uint < 12 > (0));
+            if (insn_1.range(6, 2) == OPC_AUIPC) {
+                lane1_base = pc_1;
+            }
+            return true;
+        default:
+            return false;
+        }
+    }
+    
+    // Register-register ALU operation for a funct3, the alternate one (SUB, SRA) if alt.
+    sc_uint < ALUOP_SIZE > alu_funct3(sc_uint < FUNCT3_SIZE > funct3, bool alt) {
+        switch (funct3) {
+        case FUNCT3_ADD:
+            return alt ? ALUOP_SUB : ALUOP_ADD;
+        case FUNCT3_SLL:
+            return ALUOP_SLL;
+        case FUNCT3_SLT:
+            return ALUOP_SLT;
+        case FUNCT3_SLTU:
+            return ALUOP_SLTU;
+        case FUNCT3_XOR:
+            return ALUOP_XOR;
+        case FUNCT3_SRL:
+            return alt ? ALUOP_SRA : ALUOP_SRL;
+        case FUNCT3_OR:
+            return ALUOP_OR;
+        default:
+            return ALUOP_AND;
+        }
+    }
+    
+    // Operand of the ALU lane, from the same sources as those of the first
+    // instruction. ready is cleared when its writer has not produced it yet:
+    // as for the first instruction, only a forward of the writer in the
+    // sentinel clears a pending write, not an older one written back now.
+    sc_int < XLEN > lane1_operand(sc_uint < REG_ADDR > addr, bool &ready) {
+        sc_uint < TAG_WIDTH > sent_tag = sentinel[addr].range(TAG_WIDTH, 1);
+        bool sent_valid = (sentinel[addr][0] == 1);
+        
+        ready = true;
+        if (!fwd.ldst && fwd.tag == sent_tag && sent_valid) {
+            return fwd.regfile_data;
+        } else if (fwd.valid_1 && fwd.tag_1 == sent_tag && sent_valid) {
+            return fwd.regfile_data_1;
+        } else if (!fwd_m.ldst && fwd_m.tag == sent_tag && sent_valid) {
+            return fwd_m.regfile_data;
+        } else if (fwd_m.valid_1 && fwd_m.tag_1 == sent_tag && sent_valid) {
+            return fwd_m.regfile_data_1;
+        }
+        ready = !sent_valid;
+        if (feedinput.regwrite_1 == 1 && feedinput.regfile_address_1 == addr && addr != 0) {
+            return feedinput.regfile_data_1;
+        } else if (feedinput.regwrite == 1 && feedinput.regfile_address == addr && addr != 0) {
+            return feedinput.regfile_data;
+        } else if (late_write && feedinput.late_regfile_address == addr) {
+            return feedinput.late_regfile_data;
+        }
+        return regfile.read(addr);
+    }
+    #endif
+
+    #ifdef BITMANIP
+    // ALU operation of a register-register bit-manipulation instruction,
+    // ALUOP_NULL if the encoding is not one.
+    sc_uint < ALUOP_SIZE > bitmanip_reg(sc_uint < INSN_LEN > insn) {
+        sc_uint < FUNCT3_SIZE > funct3 = insn.range(14, 12);
+        
+        switch (insn.range(31, 25)) {
+        case FUNCT7_SHADD:
+            if (funct3 == 2) return ALUOP_SH1ADD;
+            if (funct3 == 4) return ALUOP_SH2ADD;
+            if (funct3 == 6) return ALUOP_SH3ADD;
+            break;
+        case FUNCT7_MINMAX:
+            if (funct3 == 4) return ALUOP_MIN;
+            if (funct3 == 5) return ALUOP_MINU;
+            if (funct3 == 6) return ALUOP_MAX;
+            if (funct3 == 7) return ALUOP_MAXU;
+            break;
+        case FUNCT7_ZEXTH:
+            if (funct3 == 4 && insn.range(24, 20) == 0) return ALUOP_ZEXTH;
+            break;
+        case FUNCT7_ROT:
+            if (funct3 == 1) return ALUOP_ROL;
+            if (funct3 == 5) return ALUOP_ROR;
+            break;
+        case FUNCT7_BCLR:
+            if (funct3 == 1) return ALUOP_BCLR;
+            if (funct3 == 5) return ALUOP_BEXT;
+            break;
+        case FUNCT7_BINV:
+            if (funct3 == 1) return ALUOP_BINV;
+            break;
+        case FUNCT7_BSET:
+            if (funct3 == 1) return ALUOP_BSET;
+            break;
+        default:
+            break;
+        }
+        return ALUOP_NULL;
+    }
+    
+    // ALU operation of an OP-IMM bit-manipulation instruction: the unary ones and
+    // the immediate forms of ROR and of the single-bit operations.
+    sc_uint < ALUOP_SIZE > bitmanip_imm(sc_uint < INSN_LEN > insn) {
+        sc_uint < FUNCT3_SIZE > funct3 = insn.range(14, 12);
+        sc_uint < REG_ADDR > unary = insn.range(24, 20);
+        
+        switch (insn.range(31, 25)) {
+        case FUNCT7_ROT:
+            if (funct3 == 1 && unary == UNARY_CLZ) return ALUOP_CLZ;
+            if (funct3 == 1 && unary == UNARY_CTZ) return ALUOP_CTZ;
+            if (funct3 == 1 && unary == UNARY_CPOP) return ALUOP_CPOP;
+            if (funct3 == 1 && unary == UNARY_SEXTB) return ALUOP_SEXTB;
+            if (funct3 == 1 && unary == UNARY_SEXTH) return ALUOP_SEXTH;
+            if (funct3 == 5) return ALUOP_ROR;
+            break;
+        case FUNCT7_BCLR:
+            if (funct3 == 1) return ALUOP_BCLR;
+            if (funct3 == 5) return ALUOP_BEXT;
+            break;
+        case FUNCT7_BINV:
+            if (funct3 == 1) return ALUOP_BINV;
+            if (funct3 == 5 && unary == UNARY_REV8) return ALUOP_REV8;
+            break;
+        case FUNCT7_BSET:
+            if (funct3 == 1) return ALUOP_BSET;
+            if (funct3 == 5 && unary == UNARY_ORCB) return ALUOP_ORCB;
+            break;
+        default:
+            break;
+        }
+        return ALUOP_NULL;
+    }
+    #endif
+
+    #ifdef FUSION
+    // Returns how the two instructions of a fetched pair can be fused, if at all.
+    // The register written by the first one must be overwritten by the second,
+    // so that its value is not needed by anyone else. Also fills the fuse_*
+    // operands for decoding the second instruction in place of the pair.
+    sc_uint < 2 > fusion(sc_uint < INSN_LEN > first, sc_uint < INSN_LEN > second) {
+        sc_uint < OPCODE_SIZE > opcode_1 = first.range(6, 2);
+        sc_uint < OPCODE_SIZE > opcode_2 = second.range(6, 2);
+        sc_uint < REG_ADDR > rd_1 = first.range(11, 7);
+        sc_uint < REG_ADDR > rd_2 = second.range(11, 7);
+        sc_uint < REG_ADDR > rs1_2 = second.range(19, 15);
+        sc_uint < REG_ADDR > rs2_2 = second.range(24, 20);
+        sc_uint < FUNCT3_SIZE > funct3_2 = second.range(14, 12);
+        
+        if (rd_1 == 0 || rd_2 != rd_1) {
+            return FUSE_NONE;
+        }
+        
+        if ((opcode_1 == OPC_LUI || opcode_1 == OPC_AUIPC) && rs1_2 == rd_1 &&
+            ((opcode_2 == OPC_ADDI && funct3_2 == FUNCT3_ADDI) || opcode_2 == OPC_LB || opcode_2 == OPC_JALR)) {
+            fuse_value = ((sc_uint < 20 >) first.range(31, 12), sc_uint < 12 > (0));
+            if (opcode_1 == OPC_AUIPC) {
+                fuse_value = fuse_value + fetch_in.pc;
+            }
+            return FUSE_UPPER;
+        }
+        
+        if (opcode_1 == OPC_SLLI && first.range(14, 12) == FUNCT3_SLLI && first.range(31, 25) == FUNCT7_SLLI &&
+            first.range(24, 20) >= 1 && first.range(24, 20) <= 3 &&
+            opcode_2 == OPC_ADD && funct3_2 == FUNCT3_ADD && second.range(31, 25) == FUNCT7_ADD &&
+            (rs1_2 == rd_1) != (rs2_2 == rd_1)) {
+            fuse_shift = first.range(21, 20);
+            fuse_rs1 = first.range(19, 15);
+            fuse_rs2 = (rs1_2 == rd_1) ? rs2_2 : rs1_2;
+            return FUSE_SHIFT;
+        }
+        
+        return FUSE_NONE;
+    }
+    #endif
+
     // --- End of utility functions.
 };
 
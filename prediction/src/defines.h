@@ -16,9 +16,18 @@
 
 #define MUL32       1 // Enable 32x32 multiplier for MUL
 #define MUL64       1 // Enable 64x64 multiplier for MULH, MULHSU, MULHU
+#define MUL_UNIT      // Multiplications go to the pipelined multiplier unit
+#define MUL_STAGES  2 // Pipeline stages of the multiplier unit, must divide XLEN
+// ( XLEN / MUL_STAGES )
+#define MUL_CHUNK   16
+#define MUL_INFLIGHT 4 // Multiplications between execute and decode's late write
 #define DIV         1 // Enable division operations DIV, DIVU
 #define REM         1 // Enable remainder operations REM, REMU
 #define CSR_LOGIC   1 // Enable CSR logic in exe stage.
+#define BITMANIP      // Enable the Zba, Zbb and Zbs bit-manipulation extensions
+#define ZICOND        // Enable the Zicond conditional zero operations CZERO.EQZ, CZERO.NEZ
+#define ATOMIC        // Enable the A extension: LR.W, SC.W and the AMO*.W operations, done at the D$
+#define HPM_COUNTERS 4 // Number of programmable counters, mhpmcounter3 onwards (at most 6)
 
 
 // Cache size
@@ -27,41 +36,98 @@
 
 #define DATA_WIDTH 32 
 #define ADDR_WIDTH 32
-#define TAG_WIDTH 4
+#define TAG_WIDTH 5
+// ( 2^TAG_WIDTH )
+#define TAG_NUM 32
 #define SENTINEL_INIT (1 << (TAG_WIDTH - 1))
 #define FWD_ENABLE
 
+// Cache replacement policies. The ways of a set never move: only the policy
+// state of the set changes on an access.
+#define REPL_LRU 0 // Ways ordered by last access
+#define REPL_TREE_PLRU 1 // Binary tree of WAYS - 1 bits pointing away from the last access
+#define REPL_BIT_PLRU 2 // One bit per way set on access, all but the last cleared once full
+#define REPL_RANDOM 3 // Free-running LFSR
+
 // Data cache directives
 #define DCACHE_WAYS 2 // Number of ways
+// ( (int) log2( DCACHE_WAYS ) )
+#define DCACHE_WAYS_WIDTH 1
+#define DCACHE_REPLACEMENT REPL_TREE_PLRU // One of the REPL_* policies
 #define DCACHE_ENTRIES 16 // Number of blocks per way
-#define DCACHE_LINE 32 // Number of bits per block
+#define DCACHE_LINE 128 // Number of bits per block
 
 // ( (int) log2( DCACHE_ENTRIES ) )
 #define DCACHE_INDEX_WIDTH 4
 // ( (int) log2( DCACHE_LINE / DATA_WIDTH) )
-#define DCACHE_OFFSET_WIDTH 0
+#define DCACHE_OFFSET_WIDTH 2
 // ( ADDR_WIDTH - DCACHE_INDEX_WIDTH - DCACHE_OFFSET_WIDTH )
-#define DCACHE_TAG_WIDTH 28
+#define DCACHE_TAG_WIDTH 26
+// ( DCACHE_LINE / DATA_WIDTH )
+#define DCACHE_LINE_WORDS 4
 
 #define DCACHE_DATA_SIZE ( DCACHE_WAYS * DCACHE_LINE )
-#define DCACHE_TAGS_SIZE ( DCACHE_WAYS * DCACHE_TAG_WIDTH + 2 * DCACHE_WAYS) // Contais the tags and the valid/dirty bits
+#define DCACHE_TAGS_SIZE ( DCACHE_WAYS * DCACHE_TAG_WIDTH + 3 * DCACHE_WAYS) // Contais the tags and the valid/dirty/prefetched bits
+#define DCACHE_REPL_WIDTH ( DCACHE_WAYS * DCACHE_WAYS_WIDTH ) // Replacement state per set, enough for any policy
+#define STORE_BUFFER_SIZE 4 // Number of stores waiting to be written into the D$
+#define MSHR_NUM 2 // Number of D$ misses in flight
+// ( (int) log2( MSHR_NUM ) )
+#define MSHR_ID_WIDTH 1
+#define VICTIM_BUFFER_SIZE 2 // Number of dirty lines waiting to be written back to memory
+
+// Data prefetcher directives
+#define DCACHE_PREFETCH // Enable the stride prefetcher of the D$
+#define RPT_ENTRIES 16 // Number of loads/stores tracked by the reference prediction table
+// ( (int) log2( RPT_ENTRIES ) )
+#define RPT_INDEX_WIDTH 4
+#define RPT_CONFIDENCE_WIDTH 2
+// ( 2^RPT_CONFIDENCE_WIDTH - 1 )
+#define RPT_CONFIDENCE_MAX 3
+#define RPT_THRESHOLD 2 // Confidence needed to prefetch
+// ( (int) log2( strides ahead of the access to prefetch ) )
+#define RPT_DISTANCE_WIDTH 2
 
 // Instruction Cache directives
 #define ICACHE_WAYS 2 // Number of ways
+// ( (int) log2( ICACHE_WAYS ) )
+#define ICACHE_WAYS_WIDTH 1
+#define ICACHE_REPLACEMENT REPL_TREE_PLRU // One of the REPL_* policies
 #define ICACHE_ENTRIES 8 // Number of blocks per way
-#define ICACHE_LINE 64 // Number of bits per block
+#define ICACHE_LINE 128 // Number of bits per block
 
 // ( (int) log2( ICACHE_ENTRIES ) )
 #define ICACHE_INDEX_WIDTH 3
 // ( (int) log2( ICACHE_LINE / DATA_WIDTH) )
-#define ICACHE_OFFSET_WIDTH 1
+#define ICACHE_OFFSET_WIDTH 2
 // ( ADDR_WIDTH - ICACHE_INDEX_WIDTH - ICACHE_OFFSET_WIDTH )
-#define ICACHE_TAG_WIDTH 28
+#define ICACHE_TAG_WIDTH 27
+// ( ICACHE_LINE / DATA_WIDTH )
+#define ICACHE_LINE_WORDS 4
 
 #define ICACHE_DATA_SIZE ( ICACHE_WAYS * ICACHE_LINE )
 #define ICACHE_TAGS_SIZE ( ICACHE_WAYS * ICACHE_TAG_WIDTH + 2 * ICACHE_WAYS) // Contais the tags and the valid/dirty bits
+#define ICACHE_REPL_WIDTH ( ICACHE_WAYS * ICACHE_WAYS_WIDTH ) // Replacement state per set, enough for any policy
 #define ICACHE_BUFFER_SIZE ( ICACHE_LINE / ADDR_WIDTH  + 1)
 
+// Fetch width directives
+#define DUAL_FETCH // Fetch both instructions of an I$ line in the same cycle
+#define FUSION // Decode fuses common pairs fetched together (needs DUAL_FETCH)
+#define DUAL_ISSUE // The second instruction of a pair goes to a second, ALU-only lane (needs DUAL_FETCH)
+
+// Compressed instructions directives
+#define RVC // Support for compressed instructions (C extension)
+
+// Instruction prefetcher directives
+#define ICACHE_PREFETCH // Enable the next-line/stream prefetcher of the I$
+#define PREFETCH_BUFFER_SIZE 2 // Number of prefetched lines kept outside the I$
+#define PREFETCH_DEGREE 2 // Maximum number of lines requested ahead of a miss
+// ( (int) log2( PREFETCH_DEGREE ) + 1 )
+#define PREFETCH_DEGREE_WIDTH 2
+#define PREFETCH_ACCURACY_WIDTH 2
+// ( 2^PREFETCH_ACCURACY_WIDTH - 1 )
+#define PREFETCH_ACCURACY_MAX 3
+#define PREFETCH_THRESHOLD 2 // Accuracy needed to prefetch more than the next line
+
 // Branch predictor directives
 
 #define BTB_ENTRIES 32
@@ -73,11 +139,31 @@
 // (2^BTB_PREDICTION_BITS_WIDTH / 2) - 1
 #define WEAK_NON_TAKEN 1 // Branches with certainty of <= WEAK_NON_TAKEN are not taken
 #define STRONG_TAKEN 3 // Maximum value for prediction bits
+#define STATIC_PREDICTION // On a BTB miss predict JAL and backward branches taken (BTFN)
+
+// Fetch queue directives
+#define FETCH_QUEUE_SIZE 4 // Number of fetched instructions that can wait for decode
+// Redirects and BTB/RAS updates waiting for fetch, one per queued instruction
+// ( 2 * FETCH_QUEUE_SIZE )
+#define FEEDBACK_QUEUE_SIZE 8
 
 // RAS directives
 #define RAS_ENTRIES 4
 // ( (int) log2( RAS_ENTRIES ) )
 #define RAS_POINTER_SIZE 2
+
+// Register file directives
+// Writes in a cycle: writeback, a late load or unit result and, with DUAL_ISSUE, the ALU lane.
+#ifdef DUAL_ISSUE
+#define REGFILE_WRITE_PORTS 3
+#else
+#define REGFILE_WRITE_PORTS 2
+#endif
+// ( (int) ceil( log2( REGFILE_WRITE_PORTS ) ) )
+#define REGFILE_LVT_WIDTH 2
+#define REGFILE_BANKS 2 // Registers are interleaved over the banks by address
+#define REGFILE_BANK_READS 2 // Read ports of each bank
+#define REGFILE_READS 4 // Reads decode asks for in a cycle, two per lane
 // Dbg directives.
 
 #define INTERNAL_PROG // When on specifies the program to execute as an array in the fetch stage (not for production).
@@ -0,0 +1,199 @@
+/*	
+	@author VLSI Lab, EE dept., Democritus University of Thrace
+
+	@brief 
+	Header file for the divider unit.
+	Division algorithm for DIV, DIVU, REM, REMU instructions. Division by zero
+	and overflow semantics are compliant with the RISC-V specs (page 32).
+	The unit runs next to the execute stage, which goes on with the
+	instructions behind a division. The result is sent to writeback, which
+	passes it to decode as a late register write.
+
+*/
+
+#ifndef __DIVIDER__H
+#define __DIVIDER__H
+
+#ifndef NDEBUG
+    #include <iostream>
+    #define DPRINT(msg) std::cout << msg;
+#endif
+
+#include "drim4hls_datatypes.h"
+#include "defines.h"
+#include "globals.h"
+
+#include <mc_connections.h>
+
+// Signed division quotient and remainder struct.
+struct div_res_t {
+    sc_int < XLEN > quotient;
+    sc_int < XLEN > remainder;
+};
+
+// Unsigned division quotient and remainder struct.
+struct u_div_res_t {
+    sc_uint < XLEN > quotient;
+    sc_uint < XLEN > remainder;
+};
+
+SC_MODULE(divider) {
+    // Clock and reset signals
+    sc_in < bool > CCS_INIT_S1(clk);
+    sc_in < bool > CCS_INIT_S1(rst);
+    
+    // FlexChannel initiators
+    Connections::In < div_in_t > CCS_INIT_S1(din);
+    Connections::Out < unit_out_t > CCS_INIT_S1(dout);
+    
+    // Member variables
+    div_in_t input;
+    unit_out_t output;
+    
+    // Operands and result of the last division. DIV and REM of the same
+    // operands usually come in pairs, the second one reuses the result.
+    sc_uint < XLEN > div_last_num;
+    sc_uint < XLEN > div_last_den;
+    u_div_res_t div_last_res;
+    bool div_last_valid;
+    
+    // Constructor
+    SC_CTOR(divider): din("din"), dout("dout"), clk("clk"), rst("rst") {
+        SC_THREAD(divider_th);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst, false);
+    }
+
+    // Radix-4 restoring division, two quotient bits per cycle. Only the bit
+    // pairs from the highest non-zero one of the dividend down are iterated, and
+    // a zero divisor or a divisor larger than the dividend takes no iteration.
+    u_div_res_t udiv_func(sc_uint < XLEN > num, sc_uint < XLEN > den) {
+        sc_uint < XLEN + 2 > rem;
+        sc_uint < XLEN > quotient;
+        u_div_res_t u_div_res;
+        
+        // Multiples of the divisor for the quotient digits 1, 2 and 3
+        sc_uint < XLEN + 2 > den_1 = den;
+        sc_uint < XLEN + 2 > den_2 = den_1 << 1;
+        sc_uint < XLEN + 2 > den_3 = den_1 + den_2;
+        sc_int < 6 > top = -1;
+
+        if (div_last_valid && num == div_last_num && den == div_last_den) {
+            return div_last_res;
+        }
+
+        rem = 0;
+        quotient = 0;
+        
+        if (den == 0) {
+            quotient = ~quotient;
+            rem = num;
+        } else if (num < den) {
+            rem = num;
+        } else {
+            for (int i = 0; i < XLEN / 2; i++) {
+                if (num.range(2*i + 1, 2*i) != 0) {
+                    top = i;
+                }
+            }
+        }
+
+        DIVIDE_LOOP:
+            for (sc_int < 6 > i = top; i >= 0; i--) {
+                // Break EXE stage protocol for DSE
+
+                rem = (rem << 2) | num.range(2*i + 1, 2*i);
+                quotient = quotient << 2;
+
+                if (rem >= den_3) {
+                    rem -= den_3;
+                    quotient = quotient | 3;
+                } else if (rem >= den_2) {
+                    rem -= den_2;
+                    quotient = quotient | 2;
+                } else if (rem >= den_1) {
+                    rem -= den_1;
+                    quotient = quotient | 1;
+                }
+                wait();
+            }
+
+        u_div_res.quotient = quotient;
+        u_div_res.remainder = rem;
+        
+        div_last_num = num;
+        div_last_den = den;
+        div_last_res = u_div_res;
+        div_last_valid = true;
+
+        return u_div_res;
+    }
+
+    div_res_t div_func(sc_int < XLEN > num, sc_int < XLEN > den) {
+        bool num_neg;
+        bool den_neg;
+        div_res_t div_res;
+        u_div_res_t u_div_res;
+
+        num_neg = num < 0;
+        den_neg = den < 0;
+
+        if (num_neg)
+            num = -num;
+        if (den_neg)
+            den = -den;
+
+        u_div_res = udiv_func((sc_uint < XLEN > ) num, (sc_uint < XLEN > ) den);
+        div_res.quotient = (sc_int < XLEN > ) u_div_res.quotient;
+        div_res.remainder = (sc_int < XLEN > ) u_div_res.remainder;
+
+        // The remainder takes the sign of the dividend. A division by zero keeps
+        // its all-ones quotient (-1) whatever the signs.
+        if ((num_neg ^ den_neg) && den != 0)
+            div_res.quotient = -div_res.quotient;
+        if (num_neg)
+            div_res.remainder = -div_res.remainder;
+
+        return div_res;
+    }
+
+    void divider_th(void) {
+        DIVIDER_RST: {
+            din.Reset();
+            dout.Reset();
+            
+            div_last_num = 0;
+            div_last_den = 0;
+            div_last_res.quotient = 0;
+            div_last_res.remainder = 0;
+            div_last_valid = false;
+            
+            wait();
+        }
+        
+        DIVIDER_BODY: while (true) {
+            input = din.Pop();
+            
+            if (input.sign) {
+                div_res_t div_res = div_func((sc_int < XLEN >) input.num, (sc_int < XLEN >) input.den);
+                output.result = (input.rem) ? (sc_uint < XLEN >) div_res.remainder : (sc_uint < XLEN >) div_res.quotient;
+            } else {
+                u_div_res_t u_div_res = udiv_func(input.num, input.den);
+                output.result = (input.rem) ? u_div_res.remainder : u_div_res.quotient;
+            }
+            output.dest_reg = input.dest_reg;
+            output.tag = input.tag;
+            
+            dout.Push(output);
+            
+            #ifndef __SYNTHESIS__
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << std::hex << "result= " << output.result << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "tag= " << output.tag << endl);
+            #endif
+            
+            wait();
+        }
+    }
+};
+
+#endif // end __DIVIDER__H
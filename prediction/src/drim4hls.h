@@ -20,6 +20,9 @@
 #include "fetch.h"
 #include "decode.h"
 #include "execute.h"
+#include "divider.h"
+#include "multiplier.h"
+#include "memory.h"
 #include "writeback.h"
 
 #include "drim4hls_datatypes.h"
@@ -46,25 +49,41 @@ SC_MODULE(drim4hls) {
     sc_out < long int > CCS_INIT_S1(o_icount);
 
     // Inter-stage Channels and ports.
-    Connections::Combinational < fe_out_t > CCS_INIT_S1(fe2de_ch);
+    Connections::Buffer < fe_out_t, FETCH_QUEUE_SIZE > CCS_INIT_S1(fe2de_ch); // Fetch queue
     Connections::Combinational < de_out_t > CCS_INIT_S1(de2exe_ch);
-    Connections::Combinational < fe_in_t > CCS_INIT_S1(de2fe_ch);
+    Connections::Buffer < fe_in_t, FEEDBACK_QUEUE_SIZE > CCS_INIT_S1(de2fe_ch); // Decode does not wait while fetch is stuck on an I$ miss
     Connections::Combinational < mem_out_t > CCS_INIT_S1(wb2de_ch); // Writeback loop
     Connections::Combinational < exe_out_t > CCS_INIT_S1(exe2mem_ch);
+    Connections::Combinational < mem_out_t > CCS_INIT_S1(mem2wb_ch);
 
     Connections::In < imem_out_t > CCS_INIT_S1(imem2de_data);
     Connections::Out < imem_in_t > CCS_INIT_S1(fe2imem_data);
 
-    Connections::In < dmem_out_t > CCS_INIT_S1(dmem2wb_data);
-    Connections::Out < dmem_in_t > CCS_INIT_S1(wb2dmem_data);
+    Connections::In < dmem_out_t > CCS_INIT_S1(dmem2mem_data);
+    Connections::Out < dmem_in_t > CCS_INIT_S1(mem2dmem_data);
 
     // Forwarding
     Connections::Combinational < reg_forward_t > CCS_INIT_S1(fwd_exe_ch);
+    Connections::Combinational < reg_forward_t > CCS_INIT_S1(fwd_mem_ch);
+    
+    // Divider, its result waits for writeback in the buffer
+    Connections::Combinational < div_in_t > CCS_INIT_S1(exe2div_ch);
+    Connections::Buffer < unit_out_t, 1 > CCS_INIT_S1(div2wb_ch);
+    #ifdef MUL_UNIT
+    // Multiplier, the buffer holds every result decode lets in flight
+    Connections::Combinational < mul_in_t > CCS_INIT_S1(exe2mul_ch);
+    Connections::Buffer < unit_out_t, MUL_INFLIGHT > CCS_INIT_S1(mul2wb_ch);
+    #endif
 
     // Instantiate the modules
     fetch CCS_INIT_S1(fe);
     decode CCS_INIT_S1(dec);
     execute CCS_INIT_S1(exe);
+    divider CCS_INIT_S1(div_unit);
+    #ifdef MUL_UNIT
+    multiplier CCS_INIT_S1(mul_unit);
+    #endif
+    memory CCS_INIT_S1(mem);
     writeback CCS_INIT_S1(wb);
 
     SC_CTOR(drim4hls): clk("clk"),
@@ -74,15 +93,28 @@ SC_MODULE(drim4hls) {
     de2exe_ch("de2exe_ch"),
     de2fe_ch("de2fe_ch"),
     exe2mem_ch("exe2mem_ch"),
+    mem2wb_ch("mem2wb_ch"),
     wb2de_ch("wb2de_ch"),
     fwd_exe_ch("fwd_exe_ch"),
+    fwd_mem_ch("fwd_mem_ch"),
+    exe2div_ch("exe2div_ch"),
+    div2wb_ch("div2wb_ch"),
+    #ifdef MUL_UNIT
+    exe2mul_ch("exe2mul_ch"),
+    mul2wb_ch("mul2wb_ch"),
+    #endif
     imem2de_data("imem2de_data"),
     fe2imem_data("fe2imem_data"),
-    dmem2wb_data("dmem2wb_data"),
-    wb2dmem_data("wb2dmem_data"),
+    dmem2mem_data("dmem2mem_data"),
+    mem2dmem_data("mem2dmem_data"),
     fe("Fetch"),
     dec("Decode"),
     exe("Execute"),
+    div_unit("Divider"),
+    #ifdef MUL_UNIT
+    mul_unit("Multiplier"),
+    #endif
+    mem("Memory"),
     wb("Writeback") {
         // FETCH
         fe.clk(clk);
@@ -101,6 +133,7 @@ SC_MODULE(drim4hls) {
         dec.fetch_dout(de2fe_ch);
         dec.program_end(program_end);
         dec.fwd_exe(fwd_exe_ch);
+        dec.fwd_mem(fwd_mem_ch);
         dec.icount(icount);
         dec.j_icount(j_icount);
         dec.b_icount(b_icount);
@@ -113,15 +146,40 @@ SC_MODULE(drim4hls) {
         exe.din(de2exe_ch);
         exe.dout(exe2mem_ch);
         exe.fwd_exe(fwd_exe_ch);
+        exe.div_din(exe2div_ch);
+        
+        // DIV
+        div_unit.clk(clk);
+        div_unit.rst(rst);
+        div_unit.din(exe2div_ch);
+        div_unit.dout(div2wb_ch);
+        
+        #ifdef MUL_UNIT
+        // MUL
+        exe.mul_din(exe2mul_ch);
+        mul_unit.clk(clk);
+        mul_unit.rst(rst);
+        mul_unit.din(exe2mul_ch);
+        mul_unit.dout(mul2wb_ch);
+        wb.mul_dout(mul2wb_ch);
+        #endif
 
         // MEM
+        mem.clk(clk);
+        mem.rst(rst);
+        mem.din(exe2mem_ch);
+        mem.dout(mem2wb_ch);
+        mem.fwd_mem(fwd_mem_ch);
+
+        mem.dmem_in(mem2dmem_data);
+        mem.dmem_out(dmem2mem_data);
+
+        // WB
         wb.clk(clk);
         wb.rst(rst);
-        wb.din(exe2mem_ch);
+        wb.din(mem2wb_ch);
         wb.dout(wb2de_ch);
-
-        wb.dmem_in(wb2dmem_data);
-        wb.dmem_out(dmem2wb_data);
+        wb.div_dout(div2wb_ch);
     }
 
 };
@@ -129,8 +129,16 @@ struct fe_out_t {
     //
     sc_uint < PC_LEN > pc;
     sc_uint < XLEN > instr_data;
+    sc_uint < PC_LEN > pred_pc;
+    sc_uint < 1 > epoch;
+    sc_uint < 1 > rvc;
+    sc_uint < XLEN > instr_data_1;
+    sc_uint < PC_LEN > pred_pc_1;
+    bool valid_1;
+    sc_uint < 1 > rvc_1;
+    sc_uint < 1 > icache_miss;
 
-    static const int width = PC_LEN + XLEN;
+    static const int width = PC_LEN + XLEN + PC_LEN + 1 + XLEN + PC_LEN + 1 + 1 + 1 + 1;
 
     //
     // Default constructor.
@@ -138,6 +146,14 @@ struct fe_out_t {
     fe_out_t() {
         pc = 0;
         instr_data = 0;
+        pred_pc = 0;
+        epoch = 0;
+        rvc = 0;
+        instr_data_1 = 0;
+        pred_pc_1 = 0;
+        valid_1 = false;
+        rvc_1 = 0;
+        icache_miss = 0;
     }
 
     //
@@ -146,6 +162,14 @@ struct fe_out_t {
     fe_out_t(const fe_out_t & other) {
         pc = other.pc;
         instr_data = other.instr_data;
+        pred_pc = other.pred_pc;
+        epoch = other.epoch;
+        rvc = other.rvc;
+        instr_data_1 = other.instr_data_1;
+        pred_pc_1 = other.pred_pc_1;
+        valid_1 = other.valid_1;
+        rvc_1 = other.rvc_1;
+        icache_miss = other.icache_miss;
     }
 
     //
@@ -156,6 +180,22 @@ struct fe_out_t {
             return false;
         if (!(instr_data == other.instr_data))
             return false;
+        if (!(pred_pc == other.pred_pc))
+            return false;
+        if (!(epoch == other.epoch))
+            return false;
+        if (!(rvc == other.rvc))
+            return false;
+        if (!(instr_data_1 == other.instr_data_1))
+            return false;
+        if (!(pred_pc_1 == other.pred_pc_1))
+            return false;
+        if (!(valid_1 == other.valid_1))
+            return false;
+        if (!(rvc_1 == other.rvc_1))
+            return false;
+        if (!(icache_miss == other.icache_miss))
+            return false;
         return true;
     }
 
@@ -165,6 +205,14 @@ struct fe_out_t {
     inline fe_out_t & operator = (const fe_out_t & other) {
         pc = other.pc;
         instr_data = other.instr_data;
+        pred_pc = other.pred_pc;
+        epoch = other.epoch;
+        rvc = other.rvc;
+        instr_data_1 = other.instr_data_1;
+        pred_pc_1 = other.pred_pc_1;
+        valid_1 = other.valid_1;
+        rvc_1 = other.rvc_1;
+        icache_miss = other.icache_miss;
         return *this;
     }
 
@@ -172,6 +220,14 @@ struct fe_out_t {
         void Marshall(Marshaller < Size > & m) {
             m & pc;
             m & instr_data;
+            m & pred_pc;
+            m & epoch;
+            m & rvc;
+            m & instr_data_1;
+            m & pred_pc_1;
+            m & valid_1;
+            m & rvc_1;
+            m & icache_miss;
         }
 
     //
@@ -180,6 +236,14 @@ struct fe_out_t {
     inline friend void sc_trace(sc_trace_file * tf, const fe_out_t & object, const std::string & in_name) {
         sc_trace(tf, object.pc, in_name + std::string(".pc"));
         sc_trace(tf, object.instr_data, in_name + std::string(".instr_data"));
+        sc_trace(tf, object.pred_pc, in_name + std::string(".pred_pc"));
+        sc_trace(tf, object.epoch, in_name + std::string(".epoch"));
+        sc_trace(tf, object.rvc, in_name + std::string(".rvc"));
+        sc_trace(tf, object.instr_data_1, in_name + std::string(".instr_data_1"));
+        sc_trace(tf, object.pred_pc_1, in_name + std::string(".pred_pc_1"));
+        sc_trace(tf, object.valid_1, in_name + std::string(".valid_1"));
+        sc_trace(tf, object.rvc_1, in_name + std::string(".rvc_1"));
+        sc_trace(tf, object.icache_miss, in_name + std::string(".icache_miss"));
     }
 
     //
@@ -191,6 +255,14 @@ struct fe_out_t {
         os << "(";
         os << object.pc;
         os << object.instr_data;
+        os << object.pred_pc;
+        os << object.epoch;
+        os << object.rvc;
+        os << object.instr_data_1;
+        os << object.pred_pc_1;
+        os << object.valid_1;
+        os << object.rvc_1;
+        os << object.icache_miss;
         os << ")";
 
         return os;
@@ -214,6 +286,7 @@ struct de_out_t {
     sc_uint < 1 > memtoreg;
     sc_uint < 3 > ld;
     sc_uint < 2 > st;
+    sc_uint < 5 > amo;
     sc_uint < ALUOP_SIZE > alu_op;
     sc_uint < ALUSRC_SIZE > alu_src;
     sc_int < XLEN > rs1;
@@ -222,9 +295,18 @@ struct de_out_t {
     sc_uint < PC_LEN > pc;
     sc_uint < XLEN - 12 > imm_u;
     sc_uint < TAG_WIDTH > tag;
+    sc_uint < 1 > rvc;
+    sc_uint < EVENT_NUM > events;
+    sc_uint < 1 > fused;
+    sc_uint < 1 > valid_1;
+    sc_uint < ALUOP_SIZE > alu_op_1;
+    sc_int < XLEN > rs1_1;
+    sc_int < XLEN > rs2_1;
+    sc_uint < REG_ADDR > dest_reg_1;
+    sc_uint < TAG_WIDTH > tag_1;
 
     static
-    const int width = 1 + 1 + 3 + 2 + ALUOP_SIZE + ALUSRC_SIZE + 3 * XLEN - 12 + REG_ADDR + PC_LEN + TAG_WIDTH;
+    const int width = 1 + 1 + 3 + 2 + ALUOP_SIZE + ALUSRC_SIZE + 3 * XLEN - 12 + REG_ADDR + PC_LEN + TAG_WIDTH + 1 + EVENT_NUM + 1 + 1 + ALUOP_SIZE + XLEN + XLEN + REG_ADDR + TAG_WIDTH + 5;
 
     //
     // Default constructor.
@@ -234,6 +316,7 @@ struct de_out_t {
         memtoreg = 0;
         ld = NO_LOAD;
         st = NO_STORE;
+        amo = AMO_NONE;
         alu_op = 0;
         alu_src = 0;
         rs1 = 0;
@@ -242,6 +325,15 @@ struct de_out_t {
         pc = 0;
         imm_u = 0;
         tag = 0;
+        rvc = 0;
+        events = 0;
+        fused = 0;
+        valid_1 = 0;
+        alu_op_1 = ALUOP_NULL;
+        rs1_1 = 0;
+        rs2_1 = 0;
+        dest_reg_1 = 0;
+        tag_1 = 0;
     }
 
     //
@@ -252,6 +344,7 @@ struct de_out_t {
         memtoreg = other.memtoreg;
         ld = other.ld;
         st = other.st;
+        amo = other.amo;
         alu_op = other.alu_op;
         alu_src = other.alu_src;
         rs1 = other.rs1;
@@ -260,6 +353,15 @@ struct de_out_t {
         pc = other.pc;
         imm_u = other.imm_u;
         tag = other.tag;
+        rvc = other.rvc;
+        events = other.events;
+        fused = other.fused;
+        valid_1 = other.valid_1;
+        alu_op_1 = other.alu_op_1;
+        rs1_1 = other.rs1_1;
+        rs2_1 = other.rs2_1;
+        dest_reg_1 = other.dest_reg_1;
+        tag_1 = other.tag_1;
     }
 
     //
@@ -274,6 +376,8 @@ struct de_out_t {
             return false;
         if (!(st == other.st))
             return false;
+        if (!(amo == other.amo))
+            return false;
         if (!(alu_op == other.alu_op))
             return false;
         if (!(alu_src == other.alu_src))
@@ -290,6 +394,24 @@ struct de_out_t {
             return false;
         if (!(tag == other.tag))
             return false;
+        if (!(rvc == other.rvc))
+            return false;
+        if (!(events == other.events))
+            return false;
+        if (!(fused == other.fused))
+            return false;
+        if (!(valid_1 == other.valid_1))
+            return false;
+        if (!(alu_op_1 == other.alu_op_1))
+            return false;
+        if (!(rs1_1 == other.rs1_1))
+            return false;
+        if (!(rs2_1 == other.rs2_1))
+            return false;
+        if (!(dest_reg_1 == other.dest_reg_1))
+            return false;
+        if (!(tag_1 == other.tag_1))
+            return false;
         return true;
     }
 
@@ -301,6 +423,7 @@ struct de_out_t {
         memtoreg = other.memtoreg;
         ld = other.ld;
         st = other.st;
+        amo = other.amo;
         alu_op = other.alu_op;
         alu_src = other.alu_src;
         rs1 = other.rs1;
@@ -309,6 +432,15 @@ struct de_out_t {
         pc = other.pc;
         imm_u = other.imm_u;
         tag = other.tag;
+        rvc = other.rvc;
+        events = other.events;
+        fused = other.fused;
+        valid_1 = other.valid_1;
+        alu_op_1 = other.alu_op_1;
+        rs1_1 = other.rs1_1;
+        rs2_1 = other.rs2_1;
+        dest_reg_1 = other.dest_reg_1;
+        tag_1 = other.tag_1;
         return *this;
     }
 
@@ -318,6 +450,7 @@ struct de_out_t {
             m & memtoreg;
             m & ld;
             m & st;
+            m & amo;
             m & alu_op;
             m & alu_src;
             m & rs1;
@@ -326,6 +459,15 @@ struct de_out_t {
             m & pc;
             m & imm_u;
             m & tag;
+            m & rvc;
+            m & events;
+            m & fused;
+            m & valid_1;
+            m & alu_op_1;
+            m & rs1_1;
+            m & rs2_1;
+            m & dest_reg_1;
+            m & tag_1;
 
         }
 
@@ -339,6 +481,7 @@ struct de_out_t {
         sc_trace(tf, object.memtoreg, in_name + std::string(".memtoreg"));
         sc_trace(tf, object.ld, in_name + std::string(".ld"));
         sc_trace(tf, object.st, in_name + std::string(".st"));
+        sc_trace(tf, object.amo, in_name + std::string(".amo"));
         sc_trace(tf, object.alu_op, in_name + std::string(".alu_op"));
         sc_trace(tf, object.alu_src, in_name + std::string(".alu_src"));
         sc_trace(tf, object.rs1, in_name + std::string(".rs1"));
@@ -347,6 +490,15 @@ struct de_out_t {
         sc_trace(tf, object.pc, in_name + std::string(".pc"));
         sc_trace(tf, object.imm_u, in_name + std::string(".imm_u"));
         sc_trace(tf, object.tag, in_name + std::string(".tag"));
+        sc_trace(tf, object.rvc, in_name + std::string(".rvc"));
+        sc_trace(tf, object.events, in_name + std::string(".events"));
+        sc_trace(tf, object.fused, in_name + std::string(".fused"));
+        sc_trace(tf, object.valid_1, in_name + std::string(".valid_1"));
+        sc_trace(tf, object.alu_op_1, in_name + std::string(".alu_op_1"));
+        sc_trace(tf, object.rs1_1, in_name + std::string(".rs1_1"));
+        sc_trace(tf, object.rs2_1, in_name + std::string(".rs2_1"));
+        sc_trace(tf, object.dest_reg_1, in_name + std::string(".dest_reg_1"));
+        sc_trace(tf, object.tag_1, in_name + std::string(".tag_1"));
     }
 
     //
@@ -358,6 +510,7 @@ struct de_out_t {
         os << "," << object.memtoreg;
         os << "," << object.ld;
         os << "," << object.st;
+        os << "," << object.amo;
         os << "," << object.alu_op;
         os << "," << object.alu_src;
         os << "," << object.rs1;
@@ -366,6 +519,15 @@ struct de_out_t {
         os << "," << object.pc;
         os << "," << object.imm_u;
         os << "," << object.tag;
+        os << "," << object.rvc;
+        os << "," << object.events;
+        os << "," << object.fused;
+        os << "," << object.valid_1;
+        os << "," << object.alu_op_1;
+        os << "," << object.rs1_1;
+        os << "," << object.rs2_1;
+        os << "," << object.dest_reg_1;
+        os << "," << object.tag_1;
         os << ")";
 
         return os;
@@ -388,6 +550,7 @@ struct exe_out_t // TODO: fix all sizes
     //
     sc_uint < 3 > ld;
     sc_uint < 2 > st;
+    sc_uint < 5 > amo;
     sc_uint < 1 > memtoreg;
     sc_uint < 1 > regwrite;
     sc_uint < XLEN > alu_res;
@@ -395,8 +558,13 @@ struct exe_out_t // TODO: fix all sizes
     sc_uint < REG_ADDR > dest_reg;
     sc_uint < TAG_WIDTH > tag;
     sc_uint < PC_LEN > pc;
+    sc_uint < 2 > deferred; // UNIT_* that still has to produce the result
+    sc_uint < 1 > regwrite_1;
+    sc_uint < REG_ADDR > dest_reg_1;
+    sc_uint < XLEN > alu_res_1;
+    sc_uint < TAG_WIDTH > tag_1;
 
-    static const int width = 3 + 2 + 1 + 1 + XLEN + DATA_SIZE + REG_ADDR + TAG_WIDTH + PC_LEN;
+    static const int width = 3 + 2 + 1 + 1 + XLEN + DATA_SIZE + REG_ADDR + TAG_WIDTH + PC_LEN + 2 + 1 + REG_ADDR + XLEN + TAG_WIDTH + 5;
 
     //
     // Default constructor.
@@ -404,6 +572,7 @@ struct exe_out_t // TODO: fix all sizes
     exe_out_t() {
         ld = NO_LOAD;
         st = NO_STORE;
+        amo = AMO_NONE;
         memtoreg = 0;
         regwrite = 0;
         alu_res = 0;
@@ -411,6 +580,11 @@ struct exe_out_t // TODO: fix all sizes
         dest_reg = 0;
         tag = 0;
         pc = 0;
+        deferred = 0;
+        regwrite_1 = 0;
+        dest_reg_1 = 0;
+        alu_res_1 = 0;
+        tag_1 = 0;
     }
 
     //
@@ -419,6 +593,7 @@ struct exe_out_t // TODO: fix all sizes
     exe_out_t(const exe_out_t & other) {
         ld = other.ld;
         st = other.st;
+        amo = other.amo;
         memtoreg = other.memtoreg;
         regwrite = other.regwrite;
         alu_res = other.alu_res;
@@ -426,6 +601,11 @@ struct exe_out_t // TODO: fix all sizes
         dest_reg = other.dest_reg;
         tag = other.tag;
         pc = other.pc;
+        deferred = other.deferred;
+        regwrite_1 = other.regwrite_1;
+        dest_reg_1 = other.dest_reg_1;
+        alu_res_1 = other.alu_res_1;
+        tag_1 = other.tag_1;
     }
 
     //
@@ -436,6 +616,8 @@ struct exe_out_t // TODO: fix all sizes
             return false;
         if (!(st == other.st))
             return false;
+        if (!(amo == other.amo))
+            return false;
         if (!(memtoreg == other.memtoreg))
             return false;
         if (!(regwrite == other.regwrite))
@@ -450,6 +632,16 @@ struct exe_out_t // TODO: fix all sizes
             return false;
         if (!(pc == other.pc))
             return false;
+        if (!(deferred == other.deferred))
+            return false;
+        if (!(regwrite_1 == other.regwrite_1))
+            return false;
+        if (!(dest_reg_1 == other.dest_reg_1))
+            return false;
+        if (!(alu_res_1 == other.alu_res_1))
+            return false;
+        if (!(tag_1 == other.tag_1))
+            return false;
         return true;
     }
 
@@ -459,6 +651,7 @@ struct exe_out_t // TODO: fix all sizes
     inline exe_out_t & operator = (const exe_out_t & other) {
         ld = other.ld;
         st = other.st;
+        amo = other.amo;
         memtoreg = other.memtoreg;
         regwrite = other.regwrite;
         alu_res = other.alu_res;
@@ -466,6 +659,11 @@ struct exe_out_t // TODO: fix all sizes
         dest_reg = other.dest_reg;
         tag = other.tag;
         pc = other.pc;
+        deferred = other.deferred;
+        regwrite_1 = other.regwrite_1;
+        dest_reg_1 = other.dest_reg_1;
+        alu_res_1 = other.alu_res_1;
+        tag_1 = other.tag_1;
         return *this;
     }
 
@@ -473,6 +671,7 @@ struct exe_out_t // TODO: fix all sizes
         void Marshall(Marshaller < Size > & m) {
             m & ld;
             m & st;
+            m & amo;
             m & memtoreg;
             m & regwrite;
             m & alu_res;
@@ -480,6 +679,11 @@ struct exe_out_t // TODO: fix all sizes
             m & dest_reg;
             m & tag;
             m & pc;
+            m & deferred;
+            m & regwrite_1;
+            m & dest_reg_1;
+            m & alu_res_1;
+            m & tag_1;
 
         }
 
@@ -489,6 +693,7 @@ struct exe_out_t // TODO: fix all sizes
     inline friend void sc_trace(sc_trace_file * tf, const exe_out_t & object, const std::string & in_name) {
         sc_trace(tf, object.ld, in_name + std::string(".ld"));
         sc_trace(tf, object.st, in_name + std::string(".st"));
+        sc_trace(tf, object.amo, in_name + std::string(".amo"));
         sc_trace(tf, object.memtoreg, in_name + std::string(".memtoreg"));
         sc_trace(tf, object.regwrite, in_name + std::string(".regwrite"));
         sc_trace(tf, object.alu_res, in_name + std::string(".alu_res"));
@@ -496,6 +701,11 @@ struct exe_out_t // TODO: fix all sizes
         sc_trace(tf, object.dest_reg, in_name + std::string(".dest_reg"));
         sc_trace(tf, object.tag, in_name + std::string(".tag"));
         sc_trace(tf, object.pc, in_name + std::string(".pc"));
+        sc_trace(tf, object.deferred, in_name + std::string(".deferred"));
+        sc_trace(tf, object.regwrite_1, in_name + std::string(".regwrite_1"));
+        sc_trace(tf, object.dest_reg_1, in_name + std::string(".dest_reg_1"));
+        sc_trace(tf, object.alu_res_1, in_name + std::string(".alu_res_1"));
+        sc_trace(tf, object.tag_1, in_name + std::string(".tag_1"));
     }
 
     //
@@ -505,6 +715,7 @@ struct exe_out_t // TODO: fix all sizes
         os << "(";
         os << object.ld;
         os << "," << object.st;
+        os << "," << object.amo;
         os << "," << object.memtoreg;
         os << "," << object.regwrite;
         os << "," << object.alu_res;
@@ -512,6 +723,11 @@ struct exe_out_t // TODO: fix all sizes
         os << "," << object.dest_reg;
         os << "," << object.tag;
         os << "," << object.pc;
+        os << "," << object.deferred;
+        os << "," << object.regwrite_1;
+        os << "," << object.dest_reg_1;
+        os << "," << object.alu_res_1;
+        os << "," << object.tag_1;
         os << ")";
 
         return os;
@@ -536,8 +752,20 @@ struct mem_out_t {
     sc_int < XLEN > regfile_data;
     sc_uint < TAG_WIDTH > tag;
     sc_uint < PC_LEN > pc;
-
-    static const int width = 1 + REG_ADDR + XLEN + TAG_WIDTH + PC_LEN;
+    sc_uint < 1 > miss;
+    sc_uint < 1 > late_regwrite;
+    sc_uint < REG_ADDR > late_regfile_address;
+    sc_int < XLEN > late_regfile_data;
+    sc_uint < TAG_WIDTH > late_tag;
+    sc_uint < 2 > late_unit;
+    sc_uint < 1 > dcache_miss;
+    sc_uint < 2 > deferred;
+    sc_uint < 1 > regwrite_1;
+    sc_uint < REG_ADDR > regfile_address_1;
+    sc_int < XLEN > regfile_data_1;
+    sc_uint < TAG_WIDTH > tag_1;
+
+    static const int width = 1 + REG_ADDR + XLEN + TAG_WIDTH + PC_LEN + 1 + 1 + REG_ADDR + XLEN + TAG_WIDTH + 2 + 1 + 1 + REG_ADDR + XLEN + TAG_WIDTH + 2;
     //
     // Default constructor.
     //
@@ -547,6 +775,18 @@ struct mem_out_t {
         regfile_data = 0;
         tag = 0;
         pc = 0;
+        miss = 0;
+        late_regwrite = 0;
+        late_regfile_address = 0;
+        late_regfile_data = 0;
+        late_tag = 0;
+        late_unit = UNIT_NONE;
+        dcache_miss = 0;
+        deferred = UNIT_NONE;
+        regwrite_1 = 0;
+        regfile_address_1 = 0;
+        regfile_data_1 = 0;
+        tag_1 = 0;
     }
 
     //
@@ -558,6 +798,18 @@ struct mem_out_t {
         regfile_data = other.regfile_data;
         tag = other.tag;
         pc = other.pc;
+        miss = other.miss;
+        late_regwrite = other.late_regwrite;
+        late_regfile_address = other.late_regfile_address;
+        late_regfile_data = other.late_regfile_data;
+        late_tag = other.late_tag;
+        late_unit = other.late_unit;
+        dcache_miss = other.dcache_miss;
+        deferred = other.deferred;
+        regwrite_1 = other.regwrite_1;
+        regfile_address_1 = other.regfile_address_1;
+        regfile_data_1 = other.regfile_data_1;
+        tag_1 = other.tag_1;
     }
 
     //
@@ -574,6 +826,30 @@ struct mem_out_t {
             return false;
         if (!(pc == other.pc))
             return false;
+        if (!(miss == other.miss))
+            return false;
+        if (!(late_regwrite == other.late_regwrite))
+            return false;
+        if (!(late_regfile_address == other.late_regfile_address))
+            return false;
+        if (!(late_regfile_data == other.late_regfile_data))
+            return false;
+        if (!(late_tag == other.late_tag))
+            return false;
+        if (!(late_unit == other.late_unit))
+            return false;
+        if (!(dcache_miss == other.dcache_miss))
+            return false;
+        if (!(deferred == other.deferred))
+            return false;
+        if (!(regwrite_1 == other.regwrite_1))
+            return false;
+        if (!(regfile_address_1 == other.regfile_address_1))
+            return false;
+        if (!(regfile_data_1 == other.regfile_data_1))
+            return false;
+        if (!(tag_1 == other.tag_1))
+            return false;
         return true;
     }
 
@@ -586,6 +862,18 @@ struct mem_out_t {
         regfile_data = other.regfile_data;
         tag = other.tag;
         pc = other.pc;
+        miss = other.miss;
+        late_regwrite = other.late_regwrite;
+        late_regfile_address = other.late_regfile_address;
+        late_regfile_data = other.late_regfile_data;
+        late_tag = other.late_tag;
+        late_unit = other.late_unit;
+        dcache_miss = other.dcache_miss;
+        deferred = other.deferred;
+        regwrite_1 = other.regwrite_1;
+        regfile_address_1 = other.regfile_address_1;
+        regfile_data_1 = other.regfile_data_1;
+        tag_1 = other.tag_1;
         return *this;
     }
 
@@ -596,6 +884,18 @@ struct mem_out_t {
             m & regfile_data;
             m & tag;
             m & pc;
+            m & miss;
+            m & late_regwrite;
+            m & late_regfile_address;
+            m & late_regfile_data;
+            m & late_tag;
+            m & late_unit;
+            m & dcache_miss;
+            m & deferred;
+            m & regwrite_1;
+            m & regfile_address_1;
+            m & regfile_data_1;
+            m & tag_1;
         }
 
     //
@@ -607,6 +907,18 @@ struct mem_out_t {
         sc_trace(tf, object.regfile_data, in_name + std::string(".regfile_data"));
         sc_trace(tf, object.tag, in_name + std::string(".tag"));
         sc_trace(tf, object.pc, in_name + std::string(".pc"));
+        sc_trace(tf, object.miss, in_name + std::string(".miss"));
+        sc_trace(tf, object.late_regwrite, in_name + std::string(".late_regwrite"));
+        sc_trace(tf, object.late_regfile_address, in_name + std::string(".late_regfile_address"));
+        sc_trace(tf, object.late_regfile_data, in_name + std::string(".late_regfile_data"));
+        sc_trace(tf, object.late_tag, in_name + std::string(".late_tag"));
+        sc_trace(tf, object.late_unit, in_name + std::string(".late_unit"));
+        sc_trace(tf, object.dcache_miss, in_name + std::string(".dcache_miss"));
+        sc_trace(tf, object.deferred, in_name + std::string(".deferred"));
+        sc_trace(tf, object.regwrite_1, in_name + std::string(".regwrite_1"));
+        sc_trace(tf, object.regfile_address_1, in_name + std::string(".regfile_address_1"));
+        sc_trace(tf, object.regfile_data_1, in_name + std::string(".regfile_data_1"));
+        sc_trace(tf, object.tag_1, in_name + std::string(".tag_1"));
     }
 
     //
@@ -619,6 +931,18 @@ struct mem_out_t {
         os << "," << object.regfile_data;
         os << "," << object.tag;
         os << "," << object.pc;
+        os << "," << object.miss;
+        os << "," << object.late_regwrite;
+        os << "," << object.late_regfile_address;
+        os << "," << object.late_regfile_data;
+        os << "," << object.late_tag;
+        os << "," << object.late_unit;
+        os << "," << object.dcache_miss;
+        os << "," << object.deferred;
+        os << "," << object.regwrite_1;
+        os << "," << object.regfile_address_1;
+        os << "," << object.regfile_data_1;
+        os << "," << object.tag_1;
         os << ")";
         return os;
     }
@@ -641,9 +965,12 @@ struct reg_forward_t {
     bool sync_fewb;
     sc_uint < TAG_WIDTH > tag;
     sc_uint < PC_LEN > pc;
+    bool valid_1;
+    sc_uint < TAG_WIDTH > tag_1;
+    sc_int < XLEN > regfile_data_1;
 
     static
-    const int width = XLEN + 1 + 1 + TAG_WIDTH + PC_LEN;
+    const int width = XLEN + 1 + 1 + TAG_WIDTH + PC_LEN + 1 + TAG_WIDTH + XLEN;
     //
     // Default constructor.
     //
@@ -653,6 +980,9 @@ struct reg_forward_t {
         sync_fewb = false;
         tag = 0;
         pc = 0;
+        valid_1 = false;
+        tag_1 = 0;
+        regfile_data_1 = 0;
     }
 
     //
@@ -664,6 +994,9 @@ struct reg_forward_t {
         sync_fewb = other.sync_fewb;
         tag = other.tag;
         pc = other.pc;
+        valid_1 = other.valid_1;
+        tag_1 = other.tag_1;
+        regfile_data_1 = other.regfile_data_1;
     }
 
     //
@@ -680,6 +1013,12 @@ struct reg_forward_t {
             return false;
         if (!(pc == other.pc))
             return false;
+        if (!(valid_1 == other.valid_1))
+            return false;
+        if (!(tag_1 == other.tag_1))
+            return false;
+        if (!(regfile_data_1 == other.regfile_data_1))
+            return false;
         return true;
     }
 
@@ -692,6 +1031,9 @@ struct reg_forward_t {
         sync_fewb = other.sync_fewb;
         tag = other.tag;
         pc = other.pc;
+        valid_1 = other.valid_1;
+        tag_1 = other.tag_1;
+        regfile_data_1 = other.regfile_data_1;
         return *this;
     }
 
@@ -702,6 +1044,9 @@ struct reg_forward_t {
             m & sync_fewb;
             m & tag;
             m & pc;
+            m & valid_1;
+            m & tag_1;
+            m & regfile_data_1;
         }
 
     //
@@ -715,6 +1060,9 @@ struct reg_forward_t {
         sc_trace(tf, object.sync_fewb, in_name + std::string(".sync_fewb"));
         sc_trace(tf, object.tag, in_name + std::string(".tag"));
         sc_trace(tf, object.pc, in_name + std::string(".pc"));
+        sc_trace(tf, object.valid_1, in_name + std::string(".valid_1"));
+        sc_trace(tf, object.tag_1, in_name + std::string(".tag_1"));
+        sc_trace(tf, object.regfile_data_1, in_name + std::string(".regfile_data_1"));
     }
 
     //
@@ -729,6 +1077,9 @@ struct reg_forward_t {
         os << "," << object.tag;
         os << "," << object.sync_fewb;
         os << "," << object.pc;
+        os << "," << object.valid_1;
+        os << "," << object.tag_1;
+        os << "," << object.regfile_data_1;
         os << ")";
         return os;
     }
@@ -738,6 +1089,345 @@ struct reg_forward_t {
 #endif
 // ------------ reg_forward_t
 
+// Divider
+// ------------ div_in_t
+#ifndef div_in_t_SC_WRAPPER_TYPE
+#define div_in_t_SC_WRAPPER_TYPE 1
+
+struct div_in_t {
+    //
+    // Member declarations.
+    //
+    sc_uint < XLEN > num;
+    sc_uint < XLEN > den;
+    bool sign;
+    bool rem;
+    sc_uint < REG_ADDR > dest_reg;
+    sc_uint < TAG_WIDTH > tag;
+
+    static
+    const int width = XLEN + XLEN + 1 + 1 + REG_ADDR + TAG_WIDTH;
+    //
+    // Default constructor.
+    //
+    div_in_t() {
+        num = 0;
+        den = 0;
+        sign = false;
+        rem = false;
+        dest_reg = 0;
+        tag = 0;
+    }
+
+    //
+    // Copy constructor.
+    //
+    div_in_t(const div_in_t & other) {
+        num = other.num;
+        den = other.den;
+        sign = other.sign;
+        rem = other.rem;
+        dest_reg = other.dest_reg;
+        tag = other.tag;
+    }
+
+    //
+    // Comparison operator.
+    //
+    inline bool operator == (const div_in_t & other) {
+        if (!(num == other.num))
+            return false;
+        if (!(den == other.den))
+            return false;
+        if (!(sign == other.sign))
+            return false;
+        if (!(rem == other.rem))
+            return false;
+        if (!(dest_reg == other.dest_reg))
+            return false;
+        if (!(tag == other.tag))
+            return false;
+        return true;
+    }
+
+    //
+    // Assignment operator from div_in_t.
+    //
+    inline div_in_t & operator = (const div_in_t & other) {
+        num = other.num;
+        den = other.den;
+        sign = other.sign;
+        rem = other.rem;
+        dest_reg = other.dest_reg;
+        tag = other.tag;
+        return *this;
+    }
+
+    template < unsigned int Size >
+        void Marshall(Marshaller < Size > & m) {
+            m & num;
+            m & den;
+            m & sign;
+            m & rem;
+            m & dest_reg;
+            m & tag;
+        }
+
+    //
+    // sc_trace function.
+    //
+    inline friend void sc_trace(sc_trace_file * tf,
+        const div_in_t & object,
+            const std::string & in_name) {
+        sc_trace(tf, object.num, in_name + std::string(".num"));
+        sc_trace(tf, object.den, in_name + std::string(".den"));
+        sc_trace(tf, object.sign, in_name + std::string(".sign"));
+        sc_trace(tf, object.rem, in_name + std::string(".rem"));
+        sc_trace(tf, object.dest_reg, in_name + std::string(".dest_reg"));
+        sc_trace(tf, object.tag, in_name + std::string(".tag"));
+    }
+
+    //
+    // stream operator.
+    //
+    inline friend ostream & operator << (ostream & os,
+        const div_in_t & object) {
+        os << "(";
+        os << object.num;
+        os << "," << object.den;
+        os << "," << object.sign;
+        os << "," << object.rem;
+        os << "," << object.dest_reg;
+        os << "," << object.tag;
+        os << ")";
+        return os;
+    }
+
+};
+
+#endif
+// ------------ div_in_t
+
+// Result of the divider or the multiplier
+// ------------ unit_out_t
+#ifndef unit_out_t_SC_WRAPPER_TYPE
+#define unit_out_t_SC_WRAPPER_TYPE 1
+
+struct unit_out_t {
+    //
+    // Member declarations.
+    //
+    sc_uint < XLEN > result;
+    sc_uint < REG_ADDR > dest_reg;
+    sc_uint < TAG_WIDTH > tag;
+
+    static
+    const int width = XLEN + REG_ADDR + TAG_WIDTH;
+    //
+    // Default constructor.
+    //
+    unit_out_t() {
+        result = 0;
+        dest_reg = 0;
+        tag = 0;
+    }
+
+    //
+    // Copy constructor.
+    //
+    unit_out_t(const unit_out_t & other) {
+        result = other.result;
+        dest_reg = other.dest_reg;
+        tag = other.tag;
+    }
+
+    //
+    // Comparison operator.
+    //
+    inline bool operator == (const unit_out_t & other) {
+        if (!(result == other.result))
+            return false;
+        if (!(dest_reg == other.dest_reg))
+            return false;
+        if (!(tag == other.tag))
+            return false;
+        return true;
+    }
+
+    //
+    // Assignment operator from unit_out_t.
+    //
+    inline unit_out_t & operator = (const unit_out_t & other) {
+        result = other.result;
+        dest_reg = other.dest_reg;
+        tag = other.tag;
+        return *this;
+    }
+
+    template < unsigned int Size >
+        void Marshall(Marshaller < Size > & m) {
+            m & result;
+            m & dest_reg;
+            m & tag;
+        }
+
+    //
+    // sc_trace function.
+    //
+    inline friend void sc_trace(sc_trace_file * tf,
+        const unit_out_t & object,
+            const std::string & in_name) {
+        sc_trace(tf, object.result, in_name + std::string(".result"));
+        sc_trace(tf, object.dest_reg, in_name + std::string(".dest_reg"));
+        sc_trace(tf, object.tag, in_name + std::string(".tag"));
+    }
+
+    //
+    // stream operator.
+    //
+    inline friend ostream & operator << (ostream & os,
+        const unit_out_t & object) {
+        os << "(";
+        os << object.result;
+        os << "," << object.dest_reg;
+        os << "," << object.tag;
+        os << ")";
+        return os;
+    }
+
+};
+
+#endif
+// ------------ unit_out_t
+
+// Multiplier
+// ------------ mul_in_t
+#ifndef mul_in_t_SC_WRAPPER_TYPE
+#define mul_in_t_SC_WRAPPER_TYPE 1
+
+struct mul_in_t {
+    //
+    // Member declarations.
+    //
+    sc_uint < XLEN > a;
+    sc_uint < XLEN > b;
+    bool sign_a;
+    bool sign_b;
+    bool high;
+    sc_uint < REG_ADDR > dest_reg;
+    sc_uint < TAG_WIDTH > tag;
+
+    static
+    const int width = XLEN + XLEN + 1 + 1 + 1 + REG_ADDR + TAG_WIDTH;
+    //
+    // Default constructor.
+    //
+    mul_in_t() {
+        a = 0;
+        b = 0;
+        sign_a = false;
+        sign_b = false;
+        high = false;
+        dest_reg = 0;
+        tag = 0;
+    }
+
+    //
+    // Copy constructor.
+    //
+    mul_in_t(const mul_in_t & other) {
+        a = other.a;
+        b = other.b;
+        sign_a = other.sign_a;
+        sign_b = other.sign_b;
+        high = other.high;
+        dest_reg = other.dest_reg;
+        tag = other.tag;
+    }
+
+    //
+    // Comparison operator.
+    //
+    inline bool operator == (const mul_in_t & other) {
+        if (!(a == other.a))
+            return false;
+        if (!(b == other.b))
+            return false;
+        if (!(sign_a == other.sign_a))
+            return false;
+        if (!(sign_b == other.sign_b))
+            return false;
+        if (!(high == other.high))
+            return false;
+        if (!(dest_reg == other.dest_reg))
+            return false;
+        if (!(tag == other.tag))
+            return false;
+        return true;
+    }
+
+    //
+    // Assignment operator from mul_in_t.
+    //
+    inline mul_in_t & operator = (const mul_in_t & other) {
+        a = other.a;
+        b = other.b;
+        sign_a = other.sign_a;
+        sign_b = other.sign_b;
+        high = other.high;
+        dest_reg = other.dest_reg;
+        tag = other.tag;
+        return *this;
+    }
+
+    template < unsigned int Size >
+        void Marshall(Marshaller < Size > & m) {
+            m & a;
+            m & b;
+            m & sign_a;
+            m & sign_b;
+            m & high;
+            m & dest_reg;
+            m & tag;
+        }
+
+    //
+    // sc_trace function.
+    //
+    inline friend void sc_trace(sc_trace_file * tf,
+        const mul_in_t & object,
+            const std::string & in_name) {
+        sc_trace(tf, object.a, in_name + std::string(".a"));
+        sc_trace(tf, object.b, in_name + std::string(".b"));
+        sc_trace(tf, object.sign_a, in_name + std::string(".sign_a"));
+        sc_trace(tf, object.sign_b, in_name + std::string(".sign_b"));
+        sc_trace(tf, object.high, in_name + std::string(".high"));
+        sc_trace(tf, object.dest_reg, in_name + std::string(".dest_reg"));
+        sc_trace(tf, object.tag, in_name + std::string(".tag"));
+    }
+
+    //
+    // stream operator.
+    //
+    inline friend ostream & operator << (ostream & os,
+        const mul_in_t & object) {
+        os << "(";
+        os << object.a;
+        os << "," << object.b;
+        os << "," << object.sign_a;
+        os << "," << object.sign_b;
+        os << "," << object.high;
+        os << "," << object.dest_reg;
+        os << "," << object.tag;
+        os << ")";
+        return os;
+    }
+
+};
+
+#endif
+// ------------ mul_in_t
+
 // IMEMORY
 // ------------ imem_in_t
 #ifndef imem_in_t_SC_WRAPPER_TYPE
@@ -815,14 +1505,16 @@ struct imem_out_t {
     //
     // Member declarations.
     //
-    sc_uint < ICACHE_LINE > instr_data;
+    sc_uint < XLEN > instr_data;
+    sc_uint < ICACHE_OFFSET_WIDTH + 1 > word;
 
-    static const int width = ICACHE_LINE;
+    static const int width = XLEN + ICACHE_OFFSET_WIDTH + 1;
     //
     // Default constructor.
     //
     imem_out_t() {
         instr_data = 0;
+        word = 0;
     }
 
     //
@@ -830,6 +1522,7 @@ struct imem_out_t {
     //
     imem_out_t(const imem_out_t & other) {
         instr_data = other.instr_data;
+        word = other.word;
     }
 
     //
@@ -838,6 +1531,8 @@ struct imem_out_t {
     inline bool operator == (const imem_out_t & other) {
         if (!(instr_data == other.instr_data))
             return false;
+        if (!(word == other.word))
+            return false;
         return true;
     }
 
@@ -846,12 +1541,14 @@ struct imem_out_t {
     //
     inline imem_out_t & operator = (const imem_out_t & other) {
         instr_data = other.instr_data;
+        word = other.word;
         return *this;
     }
 
     template < unsigned int Size >
         void Marshall(Marshaller < Size > & m) {
             m & instr_data;
+            m & word;
         }
 
     //
@@ -859,6 +1556,7 @@ struct imem_out_t {
     //
     inline friend void sc_trace(sc_trace_file * tf, const imem_out_t & object, const std::string & in_name) {
         sc_trace(tf, object.instr_data, in_name + std::string(".instr_data"));
+        sc_trace(tf, object.word, in_name + std::string(".word"));
     }
 
     //
@@ -868,6 +1566,7 @@ struct imem_out_t {
         const imem_out_t & object) {
         os << "(";
         os << object.instr_data;
+        os << object.word;
         os << ")";
         return os;
     }
@@ -889,9 +1588,10 @@ struct dmem_in_t {
     sc_uint < DCACHE_LINE > data_in;
     bool read_en;
     bool write_en;
+    sc_uint < MSHR_ID_WIDTH > id;
 
     static
-    const int width = DCACHE_LINE + 2*XLEN + 2;
+    const int width = DCACHE_LINE + 2*XLEN + 2 + MSHR_ID_WIDTH;
     //
     // Default constructor.
     //
@@ -901,6 +1601,7 @@ struct dmem_in_t {
         data_in = 0;
         read_en = false;
         write_en = false;
+        id = 0;
     }
 
     //
@@ -912,6 +1613,7 @@ struct dmem_in_t {
         data_in = other.data_in;
         read_en = other.read_en;
         write_en = other.write_en;
+        id = other.id;
     }
 
     //
@@ -928,6 +1630,8 @@ struct dmem_in_t {
             return false;
         if (!(write_en == other.write_en))
             return false;
+        if (!(id == other.id))
+            return false;
         return true;
     }
 
@@ -940,6 +1644,7 @@ struct dmem_in_t {
         data_in = other.data_in;
         read_en = other.read_en;
         write_en = other.write_en;
+        id = other.id;
         return *this;
     }
 
@@ -950,6 +1655,7 @@ struct dmem_in_t {
             m & data_in;
             m & read_en;
             m & write_en;
+            m & id;
         }
 
     //
@@ -961,6 +1667,7 @@ struct dmem_in_t {
         sc_trace(tf, object.data_in, in_name + std::string(".data_in"));
         sc_trace(tf, object.read_en, in_name + std::string(".read_en"));
         sc_trace(tf, object.write_en, in_name + std::string(".write_en"));
+        sc_trace(tf, object.id, in_name + std::string(".id"));
     }
 
     //
@@ -974,6 +1681,7 @@ struct dmem_in_t {
         os << object.data_in;
         os << object.read_en;
         os << object.write_en;
+        os << object.id;
         os << ")";
         return os;
     }
@@ -990,14 +1698,18 @@ struct dmem_out_t {
     //
     // Member declarations.
     //
-    sc_uint < DCACHE_LINE > data_out;
+    sc_uint < XLEN > data_out;
+    sc_uint < DCACHE_OFFSET_WIDTH + 1 > word;
+    sc_uint < MSHR_ID_WIDTH > id;
 
-    static const int width = DCACHE_LINE;
+    static const int width = XLEN + MSHR_ID_WIDTH + DCACHE_OFFSET_WIDTH + 1;
     //
     // Default constructor.
     //
     dmem_out_t() {
         data_out = 0;
+        word = 0;
+        id = 0;
     }
 
     //
@@ -1005,6 +1717,8 @@ struct dmem_out_t {
     //
     dmem_out_t(const dmem_out_t & other) {
         data_out = other.data_out;
+        word = other.word;
+        id = other.id;
     }
 
     //
@@ -1013,6 +1727,10 @@ struct dmem_out_t {
     inline bool operator == (const dmem_out_t & other) {
         if (!(data_out == other.data_out))
             return false;
+        if (!(word == other.word))
+            return false;
+        if (!(id == other.id))
+            return false;
         return true;
     }
 
@@ -1021,12 +1739,16 @@ struct dmem_out_t {
     //
     inline dmem_out_t & operator = (const dmem_out_t & other) {
         data_out = other.data_out;
+        word = other.word;
+        id = other.id;
         return *this;
     }
 
     template < unsigned int Size >
         void Marshall(Marshaller < Size > & m) {
             m & data_out;
+            m & word;
+            m & id;
         }
 
     //
@@ -1034,6 +1756,8 @@ struct dmem_out_t {
     //
     inline friend void sc_trace(sc_trace_file * tf, const dmem_out_t & object, const std::string & in_name) {
         sc_trace(tf, object.data_out, in_name + std::string(".data_out"));
+        sc_trace(tf, object.word, in_name + std::string(".word"));
+        sc_trace(tf, object.id, in_name + std::string(".id"));
     }
 
     //
@@ -1043,6 +1767,8 @@ struct dmem_out_t {
         const dmem_out_t & object) {
         os << "(";
         os << object.data_out;
+        os << object.word;
+        os << object.id;
         os << ")";
         return os;
     }
@@ -1063,11 +1789,13 @@ struct fe_in_t {
     sc_uint < PC_LEN > address;
     bool btb_update;
     bool ras_update;
+    bool ras_pop;
     bool branch_taken;
     sc_uint < PC_LEN > pc;
     sc_uint < PC_LEN > bta;
+    sc_uint < 1 > rvc;
 
-    static const int width = 2 + PC_LEN + 3 + PC_LEN + PC_LEN;
+    static const int width = 2 + PC_LEN + 4 + PC_LEN + PC_LEN + 1;
     //
     // Default constructor.
     //
@@ -1077,9 +1805,11 @@ struct fe_in_t {
         address = 0;
         btb_update = false;
         ras_update = false;
+        ras_pop = false;
         branch_taken = false; 
         pc = 0;
         bta = 0;
+        rvc = 0;
     }
 
     //
@@ -1091,9 +1821,11 @@ struct fe_in_t {
         address = other.address;
         btb_update = other.btb_update;
         ras_update = other.ras_update;
+        ras_pop = other.ras_pop;
         branch_taken = other.branch_taken;
         pc = other.pc;
         bta = other.bta;
+        rvc = other.rvc;
     }
 
     //
@@ -1110,12 +1842,16 @@ struct fe_in_t {
             return false;
         if (!(ras_update == other.ras_update))
             return false;
+        if (!(ras_pop == other.ras_pop))
+            return false;
         if (!(branch_taken == other.branch_taken))
             return false;   
         if (!(pc == other.pc))
             return false;
         if (!(bta == other.bta))
             return false;
+        if (!(rvc == other.rvc))
+            return false;
         return true;
     }
 
@@ -1128,9 +1864,11 @@ struct fe_in_t {
         address = other.address;
         btb_update = other.btb_update;
         ras_update = other.ras_update;
+        ras_pop = other.ras_pop;
         branch_taken = other.branch_taken;
         pc = other.pc;
         bta = other.bta;
+        rvc = other.rvc;
 
         return *this;
     }
@@ -1142,9 +1880,11 @@ struct fe_in_t {
             m & address;
             m & btb_update;
             m & ras_update;
+            m & ras_pop;
             m & branch_taken;
             m & pc;
             m & bta;
+            m & rvc;
         }
 
     //
@@ -1156,9 +1896,11 @@ struct fe_in_t {
         sc_trace(tf, object.address, in_name + std::string(".address"));
         sc_trace(tf, object.btb_update, in_name + std::string(".btb_update"));
         sc_trace(tf, object.ras_update, in_name + std::string(".ras_update"));
+        sc_trace(tf, object.ras_pop, in_name + std::string(".ras_pop"));
         sc_trace(tf, object.branch_taken, in_name + std::string(".branch_taken"));
         sc_trace(tf, object.pc, in_name + std::string(".pc"));
         sc_trace(tf, object.bta, in_name + std::string(".bta"));
+        sc_trace(tf, object.rvc, in_name + std::string(".rvc"));
     }
 
     //
@@ -1172,9 +1914,11 @@ struct fe_in_t {
         os << object.address;
         os << object.btb_update;
         os << object.ras_update;
+        os << object.ras_pop;
         os << object.branch_taken;
         os << object.pc;
         os << object.bta;
+        os << object.rvc;
         os << ")";
         return os;
     }
@@ -1484,8 +2228,9 @@ struct dcache_tag_t {
     sc_uint < DCACHE_TAG_WIDTH > tag;
     bool valid;
     bool dirty;
+    bool prefetched;
 
-    static const int width = DCACHE_TAG_WIDTH + 2;
+    static const int width = DCACHE_TAG_WIDTH + 3;
     //
     // Default constructor.
     //
@@ -1493,6 +2238,7 @@ struct dcache_tag_t {
         tag = 0;
         valid = false;
         dirty = false;
+        prefetched = false;
     }
 
     //
@@ -1502,6 +2248,7 @@ struct dcache_tag_t {
         tag = other.tag;
         valid = other.valid;
         dirty = other.dirty;
+        prefetched = other.prefetched;
     }
 
     //
@@ -1514,6 +2261,8 @@ struct dcache_tag_t {
             return false;
         if (!(dirty == other.dirty))
             return false;
+        if (!(prefetched == other.prefetched))
+            return false;
         return true;
     }
 
@@ -1524,6 +2273,7 @@ struct dcache_tag_t {
         tag = other.tag;
         valid = other.valid;
         dirty = other.dirty;
+        prefetched = other.prefetched;
 
         return *this;
     }
@@ -1533,6 +2283,7 @@ struct dcache_tag_t {
             m & tag;
             m & valid;
             m & dirty;
+            m & prefetched;
         }
 
     //
@@ -1542,6 +2293,7 @@ struct dcache_tag_t {
         sc_trace(tf, object.tag, in_name + std::string(".tag"));
         sc_trace(tf, object.valid, in_name + std::string(".valid"));
         sc_trace(tf, object.dirty, in_name + std::string(".dirty"));
+        sc_trace(tf, object.prefetched, in_name + std::string(".prefetched"));
     }
 
     //
@@ -1553,6 +2305,7 @@ struct dcache_tag_t {
         os << object.tag;
         os << object.valid;
         os << object.dirty;
+        os << object.prefetched;
         os << ")";
         return os;
     }
@@ -1648,8 +2401,9 @@ struct btb_data_t {
     sc_uint < BTB_TAG_WIDTH > tag;
     sc_uint < PC_LEN > bta;
     sc_uint < BTB_PREDICTION_BITS_WIDTH > prediction_data;
+    bool valid;
 
-    static const int width = BTB_TAG_WIDTH + PC_LEN + BTB_PREDICTION_BITS_WIDTH;
+    static const int width = BTB_TAG_WIDTH + PC_LEN + BTB_PREDICTION_BITS_WIDTH + 1;
     //
     // Default constructor.
     //
@@ -1657,6 +2411,7 @@ struct btb_data_t {
         tag = 0;
         bta = 0;
         prediction_data = 0;
+        valid = false;
     }
 
     //
@@ -1666,6 +2421,7 @@ struct btb_data_t {
         tag = other.tag;
         bta = other.bta;
         prediction_data = other.prediction_data;
+        valid = other.valid;
     }
 
     //
@@ -1678,6 +2434,8 @@ struct btb_data_t {
             return false;
         if (!(prediction_data == other.prediction_data))
             return false;
+        if (!(valid == other.valid))
+            return false;
         return true;
     }
 
@@ -1688,6 +2446,7 @@ struct btb_data_t {
         tag = other.tag;
         bta = other.bta;
         prediction_data = other.prediction_data;
+        valid = other.valid;
 
         return *this;
     }
@@ -1697,6 +2456,7 @@ struct btb_data_t {
             m & tag;
             m & bta;
             m & prediction_data;
+            m & valid;
         }
 
     //
@@ -1706,6 +2466,7 @@ struct btb_data_t {
         sc_trace(tf, object.tag, in_name + std::string(".tag"));
         sc_trace(tf, object.bta, in_name + std::string(".bta"));
         sc_trace(tf, object.prediction_data, in_name + std::string(".prediction_data"));
+        sc_trace(tf, object.valid, in_name + std::string(".valid"));
     }
 
     //
@@ -1717,6 +2478,7 @@ struct btb_data_t {
         os << object.tag;
         os << object.bta;
         os << object.prediction_data;
+        os << object.valid;
         os << ")";
         return os;
     }
@@ -1733,16 +2495,20 @@ struct btb_out_t {
     // Member declarations.
     //
     bool btb_valid;
+    bool btb_hit;
     bool ras_valid;
+    bool static_valid;
     sc_uint < PC_LEN > bta;
 
-    static const int width = 2 + PC_LEN;
+    static const int width = 4 + PC_LEN;
     //
     // Default constructor.
     //
     btb_out_t() {
         btb_valid = false;
+        btb_hit = false;
         ras_valid = false;
+        static_valid = false;
         bta = 0;
     }
 
@@ -1751,7 +2517,9 @@ struct btb_out_t {
     //
     btb_out_t(const btb_out_t &other) {
         btb_valid = other.btb_valid;
+        btb_hit = other.btb_hit;
         ras_valid = other.ras_valid;
+        static_valid = other.static_valid;
         bta = other.bta;
     }
 
@@ -1761,8 +2529,12 @@ struct btb_out_t {
     inline bool operator == (const btb_out_t &other) {
         if (!(btb_valid == other.btb_valid))
             return false;
+        if (!(btb_hit == other.btb_hit))
+            return false;
         if (!(ras_valid == other.ras_valid))
             return false;
+        if (!(static_valid == other.static_valid))
+            return false;
         if (!(bta == other.bta))
             return false;
         return true;
@@ -1773,7 +2545,9 @@ struct btb_out_t {
     //
     inline btb_out_t & operator = (const btb_out_t &other) {
         btb_valid = other.btb_valid;
+        btb_hit = other.btb_hit;
         ras_valid = other.ras_valid;
+        static_valid = other.static_valid;
         bta = other.bta;
         
         return *this;
@@ -1782,7 +2556,9 @@ struct btb_out_t {
     template < unsigned int Size >
         void Marshall(Marshaller < Size > & m) {
             m & btb_valid;
+            m & btb_hit;
             m & ras_valid;
+            m & static_valid;
             m & bta;
         }
 
@@ -1791,7 +2567,9 @@ struct btb_out_t {
     //
     inline friend void sc_trace(sc_trace_file * tf, const btb_out_t & object, const std::string & in_name) {
         sc_trace(tf, object.btb_valid, in_name + std::string(".btb_valid"));
+        sc_trace(tf, object.btb_hit, in_name + std::string(".btb_hit"));
         sc_trace(tf, object.ras_valid, in_name + std::string(".ras_valid"));
+        sc_trace(tf, object.static_valid, in_name + std::string(".static_valid"));
         sc_trace(tf, object.bta, in_name + std::string(".bta"));
     }
 
@@ -1802,7 +2580,9 @@ struct btb_out_t {
         const btb_out_t & object) {
         os << "(";
         os << object.btb_valid;
+        os << object.btb_hit;
         os << object.ras_valid;
+        os << object.static_valid;
         os << object.bta;
         os << ")";
         return os;
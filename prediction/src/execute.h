@@ -3,8 +3,7 @@
 
 	@brief 
 	Header file for execute stage.
-	Division algorithm for DIV, DIVU, REM, REMU instructions. Division by zero
-	and overflow semantics are compliant with the RISC-V specs (page 32).
+	DIV, DIVU, REM and REMU are handed to the divider unit (divider.h).
 
 	@note Changes from HL5
 
@@ -33,18 +32,6 @@
 
 #include <mc_connections.h>
 
-// Signed division quotient and remainder struct.
-struct div_res_t {
-    sc_int < XLEN > quotient;
-    sc_int < XLEN > remainder;
-};
-
-// Unsigned division quotient and remainder struct.
-struct u_div_res_t {
-    sc_uint < XLEN > quotient;
-    sc_uint < XLEN > remainder;
-};
-
 SC_MODULE(execute) {
     
     #ifndef __SYNTHESIS__
@@ -76,6 +63,12 @@ SC_MODULE(execute) {
     Connections::Out < exe_out_t > CCS_INIT_S1(dout);
     // Forward
     Connections::Out < reg_forward_t > CCS_INIT_S1(fwd_exe);
+    // Divider
+    Connections::Out < div_in_t > CCS_INIT_S1(div_din);
+    #ifdef MUL_UNIT
+    // Multiplier
+    Connections::Out < mul_in_t > CCS_INIT_S1(mul_din);
+    #endif
     
     // Member variables
     de_out_t data_in;
@@ -83,89 +76,55 @@ SC_MODULE(execute) {
     exe_out_t output;
     dmem_in_t dmem_din;
     reg_forward_t forward;
+    div_in_t div_req;
+    #ifdef MUL_UNIT
+    mul_in_t mul_req;
+    #endif
 
     sc_uint < XLEN > csr[CSR_NUM]; // Control and status registers.
 
     bool freeze;
     
     // Constructor
-    SC_CTOR(execute): din("din"), dout("dout"), fwd_exe("fwd_exe"), clk("clk"), rst("rst") {
+    SC_CTOR(execute): din("din"), dout("dout"), fwd_exe("fwd_exe"), div_din("div_din"),
+    #ifdef MUL_UNIT
+    mul_din("mul_din"),
+    #endif
+    clk("clk"), rst("rst") {
         SC_THREAD(execute_th);
         sensitive << clk.pos();
         async_reset_signal_is(rst, false);
     }
 
-    u_div_res_t udiv_func(sc_uint < XLEN > num, sc_uint < XLEN > den) {
-        sc_uint < XLEN > rem;
-        sc_uint < XLEN > quotient;
-        u_div_res_t u_div_res;
-
-        rem = 0;
-        quotient = 0;
-
-        DIVIDE_LOOP:
-            for (sc_int < 6 > i = 31; i >= 0; i--) {
-                // Break EXE stage protocol for DSE
-
-                const sc_uint < XLEN > mask = BIT(i);
-                const sc_uint < XLEN > lsb = (mask & num) >> i;
-
-                rem = rem << 1;
-                rem = rem | lsb;
-
-                if (rem >= den) {
-                    rem -= den;
-                    quotient = quotient | mask;
-                }
-                wait();
-            }
-
-        u_div_res.quotient = quotient;
-        u_div_res.remainder = rem;
-
-        return u_div_res;
-    }
-
-    div_res_t div_func(sc_int < XLEN > num, sc_int < XLEN > den) {
-        bool num_neg;
-        bool den_neg;
-        div_res_t div_res;
-        u_div_res_t u_div_res;
-
-        num_neg = num < 0;
-        den_neg = den < 0;
-
-        if (num_neg)
-            num = -num;
-        if (den_neg)
-            den = -den;
-
-        u_div_res = udiv_func((sc_uint < XLEN > ) num, (sc_uint < XLEN > ) den);
-        div_res.quotient = (sc_int < XLEN > ) u_div_res.quotient;
-        div_res.remainder = (sc_int < XLEN > ) u_div_res.remainder;
-
-        if (num_neg ^ den_neg)
-            div_res.quotient = -div_res.quotient;
-        else
-            div_res.quotient = div_res.quotient;
-
-        return div_res;
-    }
-
     void execute_th(void) {
         EXE_RST: {
             din.Reset();
             dout.Reset();
             fwd_exe.Reset();
+            div_din.Reset();
+            #ifdef MUL_UNIT
+            mul_din.Reset();
+            #endif
 			
             output.tag = 0;
 
+            #ifdef RVC
+            csr[MISA_I] = 0x40001105; // RV32IMAC
+            #else
             csr[MISA_I] = 0x40001101; // RV32IMA
+            #endif
             csr[MARCHID_I] = 0x0; // Not implemented (should be assigned by RISC-V
             csr[MIMPID_I] = 0x0; // Not implemented (processor revision)
             csr[MHARTID_I] = 0x0; // Single thread (always 0)
             csr[MINSTRET_I] = 0x0; // Retired instructions
-            csr[MCYCLE_I] = 0x0; // Cycle count (32-bits only for now)
+            csr[MINSTRETH_I] = 0x0;
+            csr[MCYCLE_I] = 0x0; // Cycle count
+            csr[MCYCLEH_I] = 0x0;
+            for (int i = 0; i < PRF_CNT_NUM; i++) {
+                csr[MHPMCOUNTER_I + i] = 0x0;
+                csr[MHPMCOUNTERH_I + i] = 0x0;
+                csr[MHPMEVENT_I + i] = 0x0; // Counts nothing until software selects events
+            }
 			
             wait();
         }
@@ -174,18 +133,26 @@ SC_MODULE(execute) {
         #pragma pipeline_stall_mode flush
         EXE_BODY: while (true) {
             input = din.Pop();
-            
-            csr[MCYCLE_I]++;            
 
             // Compute
             output.regwrite = input.regwrite;
             output.memtoreg = input.memtoreg;
             output.ld = input.ld;
             output.st = input.st;
+            output.amo = input.amo;
             output.dest_reg = input.dest_reg;
             output.mem_datain = input.rs2;
             output.tag = input.tag;
             output.pc = input.pc;
+            output.deferred = UNIT_NONE;
+            
+            #ifdef DUAL_ISSUE
+            // Second lane: the ALU alone, decode has resolved both operands
+            output.regwrite_1 = (input.valid_1 == 1 && input.dest_reg_1 != 0);
+            output.dest_reg_1 = input.dest_reg_1;
+            output.tag_1 = input.tag_1;
+            output.alu_res_1 = lane1_alu(input.alu_op_1, input.rs1_1, input.rs2_1);
+            #endif
 			
             bool nop = false;
             if (input.regwrite[0] == 0 &&
@@ -194,22 +161,12 @@ SC_MODULE(execute) {
                 input.alu_op == ALUOP_NULL) {
                 nop = true;
             }
-            #ifdef MUL64
+            // Before the CSR instructions, so that a write to a counter wins
+            perf_count(nop);
+            #if defined(MUL64) && !defined(MUL_UNIT)
             // 64-bit temporary multiplication result, for upper 32 bit multiplications (MULH, MULHU, MULHSU).
-            //int64_t tmp_mul_res = 0;
             sc_uint <64> tmp_mul_res = 0;
             #endif
-            #ifdef DIV
-            // Temporary division results.
-            div_res_t div_res = {
-                0,
-                0
-            };
-            u_div_res_t u_div_res = {
-                0,
-                0
-            };
-            #endif
             #ifdef CSR_LOGIC
             // Temporary CSR index
             sc_uint < CSR_IDX_LEN > csr_index = 0;
@@ -395,7 +352,7 @@ SC_MODULE(execute) {
                 break;
             case ALUOP_JAL: // JAL, JALR
                 // link register update
-                output.alu_res = (sc_int < XLEN >) input.pc + 4;
+                output.alu_res = (sc_int < XLEN >) input.pc + (input.rvc == 1 ? 2 : 4);
 
                 #ifndef __SYNTHESIS__
                 debug_exe_out_t.alu_op = "ALUOP_JAL";
@@ -404,7 +361,11 @@ SC_MODULE(execute) {
                 break;
                 #ifdef MUL32
             case ALUOP_MUL: // MUL: signed * signed, return lower 32 bits
+                #ifdef MUL_UNIT
+                mul_issue(input.rs1, tmp_rs2, true, true, false);
+                #else
                 output.alu_res = (sc_int < XLEN >) input.rs1 * (sc_int < XLEN >) tmp_rs2;
+                #endif
 
                 #ifndef __SYNTHESIS__
                 debug_exe_out_t.alu_op = "ALUOP_MUL";
@@ -414,8 +375,12 @@ SC_MODULE(execute) {
                 #endif
                 #ifdef MUL64
             case ALUOP_MULH: // MULH: signed * signed, return upper 32 bits
+                #ifdef MUL_UNIT
+                mul_issue(input.rs1, tmp_rs2, true, true, true);
+                #else
                 tmp_mul_res = input.rs1.to_int() * tmp_rs2.to_int();
                 output.alu_res = sc_uint<XLEN*2>(sc_int<XLEN*2>(tmp_mul_res)).range((XLEN*2)-1, XLEN);
+                #endif
 
                 #ifndef __SYNTHESIS__
                 debug_exe_out_t.alu_op = "ALUOP_MULH";
@@ -423,8 +388,12 @@ SC_MODULE(execute) {
 
                 break;
             case ALUOP_MULHSU: // MULHSU: signed * unsigned, return upper 32 bits
+                #ifdef MUL_UNIT
+                mul_issue(input.rs1, tmp_rs2, true, false, true);
+                #else
                 tmp_mul_res = input.rs1 * tmp_rs2.to_uint();
                 output.alu_res = sc_uint<XLEN*2>(sc_int<XLEN*2>(tmp_mul_res)).range((XLEN*2)-1, XLEN);
+                #endif
 
                 #ifndef __SYNTHESIS__
                 debug_exe_out_t.alu_op = "ALUOP_MULHSU";
@@ -432,8 +401,12 @@ SC_MODULE(execute) {
 
                 break;
             case ALUOP_MULHU: // MULHU: unsigned * unsigned, return upper 32 bits
+                #ifdef MUL_UNIT
+                mul_issue(input.rs1, tmp_rs2, false, false, true);
+                #else
                 tmp_mul_res = input.rs1.to_int() * tmp_rs2.to_uint();
                 output.alu_res = sc_uint<XLEN*2>(sc_int<XLEN*2>(tmp_mul_res)).range((XLEN*2)-1, XLEN);
+                #endif
 
                 #ifndef __SYNTHESIS__
                 debug_exe_out_t.alu_op = "ALUOP_MULHU";
@@ -442,18 +415,16 @@ SC_MODULE(execute) {
                 break;
                 #endif
                 #ifdef DIV
-            case ALUOP_DIV: // DIV calls div_func
-                div_res = div_func((sc_int < XLEN >) input.rs1, (sc_int < XLEN >) tmp_rs2);
-                output.alu_res = div_res.quotient;
+            case ALUOP_DIV: // DIV goes to the divider
+                div_issue(input.rs1, tmp_rs2, true, false);
 
                 #ifndef __SYNTHESIS__
                 debug_exe_out_t.alu_op = "ALUOP_DIV";
                 #endif
 
                 break;
-            case ALUOP_DIVU: // DIVU calls udiv_func
-                u_div_res = udiv_func(input.rs1.to_uint(), tmp_rs2.to_uint());
-                output.alu_res = u_div_res.quotient;
+            case ALUOP_DIVU: // DIVU goes to the divider
+                div_issue(input.rs1, tmp_rs2, false, false);
 
                 #ifndef __SYNTHESIS__
                 debug_exe_out_t.alu_op = "ALUOP_DIVU";
@@ -462,18 +433,16 @@ SC_MODULE(execute) {
                 break;
                 #endif
                 #ifdef REM
-            case ALUOP_REM: // REM calls div_func
-                div_res = div_func((sc_int < XLEN >) input.rs1, (sc_int < XLEN >) tmp_rs2);
-                output.alu_res = div_res.remainder;
+            case ALUOP_REM: // REM goes to the divider
+                div_issue(input.rs1, tmp_rs2, true, true);
 
                 #ifndef __SYNTHESIS__
                 debug_exe_out_t.alu_op = "ALUOP_REM";
                 #endif
 
                 break;
-            case ALUOP_REMU: // REMU calls udiv_func
-                u_div_res = udiv_func( input.rs1.to_uint(), tmp_rs2.to_uint());
-                output.alu_res = u_div_res.remainder;
+            case ALUOP_REMU: // REMU goes to the divider
+                div_issue(input.rs1, tmp_rs2, false, true);
 
                 #ifndef __SYNTHESIS__
                 debug_exe_out_t.alu_op = "ALUOP_REMU";
@@ -544,6 +513,57 @@ SC_MODULE(execute) {
                 debug_exe_out_t.alu_op = "ALUOP_CSRRCI";
                 #endif
 
+                break;
+                #endif
+                #ifdef ZICOND
+            case ALUOP_CZEROEQZ: // CZERO.EQZ: rs1, or zero if rs2 is zero
+                output.alu_res = (tmp_rs2 == 0) ? (sc_uint < XLEN >) 0 : (sc_uint < XLEN >) input.rs1;
+
+                #ifndef __SYNTHESIS__
+                debug_exe_out_t.alu_op = "ALUOP_CZEROEQZ";
+                #endif
+
+                break;
+            case ALUOP_CZERONEZ: // CZERO.NEZ: rs1, or zero if rs2 is not zero
+                output.alu_res = (tmp_rs2 != 0) ? (sc_uint < XLEN >) 0 : (sc_uint < XLEN >) input.rs1;
+
+                #ifndef __SYNTHESIS__
+                debug_exe_out_t.alu_op = "ALUOP_CZERONEZ";
+                #endif
+
+                break;
+                #endif
+                #ifdef BITMANIP
+            case ALUOP_SH1ADD: // Zba
+            case ALUOP_SH2ADD:
+            case ALUOP_SH3ADD:
+            case ALUOP_ANDN: // Zbb
+            case ALUOP_ORN:
+            case ALUOP_XNOR:
+            case ALUOP_CLZ:
+            case ALUOP_CTZ:
+            case ALUOP_CPOP:
+            case ALUOP_MIN:
+            case ALUOP_MINU:
+            case ALUOP_MAX:
+            case ALUOP_MAXU:
+            case ALUOP_SEXTB:
+            case ALUOP_SEXTH:
+            case ALUOP_ZEXTH:
+            case ALUOP_REV8:
+            case ALUOP_ORCB:
+            case ALUOP_ROL:
+            case ALUOP_ROR:
+            case ALUOP_BSET: // Zbs
+            case ALUOP_BCLR:
+            case ALUOP_BINV:
+            case ALUOP_BEXT:
+                output.alu_res = bitmanip(input.alu_op, input.rs1, tmp_rs2);
+
+                #ifndef __SYNTHESIS__
+                debug_exe_out_t.alu_op = "ALUOP_BITMANIP";
+                #endif
+
                 break;
                 #endif
             default: // ALUOP_NULL (do nothing)
@@ -556,25 +576,22 @@ SC_MODULE(execute) {
                 break;
             }
 			
-            if ((input.ld != NO_LOAD || input.st != NO_STORE) && !nop) {
-                forward.ldst = true;
-            } else {
-                forward.ldst = false;
-            }
-
-            if (output.alu_res == ALUOP_NULL) {
-                forward.ldst = true;
-            }
-
+            // A bubble leaves the last forward untouched: its value is still the
+            // correct one for its tag, or it is still marked as not yet available.
             if (!nop) {
+                // alu_res of a load/store is the address, the data is only known in the memory stage.
+                // Neither is the result of a division or a multiplication.
+                forward.ldst = (input.ld != NO_LOAD || input.st != NO_STORE || output.deferred != UNIT_NONE);
                 forward.tag = output.tag;
                 forward.regfile_data = output.alu_res;
                 forward.pc = input.pc;
+                #ifdef DUAL_ISSUE
+                forward.valid_1 = (input.valid_1 == 1);
+                forward.tag_1 = input.tag_1;
+                forward.regfile_data_1 = output.alu_res_1;
+                #endif
             }
 
-            if (!nop)
-               csr[MINSTRET_I]++;
-
             // Put
 			fwd_exe.Push(forward);
             dout.Push(output);
@@ -598,6 +615,191 @@ SC_MODULE(execute) {
 
     /* Support functions */
 
+    // Hands a division to the divider unit. The instruction goes on to writeback
+    // without its result, which the divider sends there once done. Decode keeps
+    // a single division in flight, so the divider is always free to take it.
+    // A division without a destination register has no effect and is dropped.
+    void div_issue(sc_uint < XLEN > num, sc_uint < XLEN > den, bool sign, bool rem) {
+        output.alu_res = 0;
+        if (input.regwrite[0] == 1 && input.dest_reg != 0) {
+            div_req.num = num;
+            div_req.den = den;
+            div_req.sign = sign;
+            div_req.rem = rem;
+            div_req.dest_reg = input.dest_reg;
+            div_req.tag = input.tag;
+            div_din.Push(div_req);
+            output.deferred = UNIT_DIV;
+        }
+    }
+    
+    #ifdef MUL_UNIT
+    // Hands a multiplication to the multiplier unit, like div_issue(). Decode
+    // keeps no more in flight than the multiplier can hold.
+    void mul_issue(sc_uint < XLEN > a, sc_uint < XLEN > b, bool sign_a, bool sign_b, bool high) {
+        output.alu_res = 0;
+        if (input.regwrite[0] == 1 && input.dest_reg != 0) {
+            mul_req.a = a;
+            mul_req.b = b;
+            mul_req.sign_a = sign_a;
+            mul_req.sign_b = sign_b;
+            mul_req.high = high;
+            mul_req.dest_reg = input.dest_reg;
+            mul_req.tag = input.tag;
+            mul_din.Push(mul_req);
+            output.deferred = UNIT_MUL;
+        }
+    }
+    #endif
+
+    // Advances the 64-bit cycle and retired instruction counters and the
+    // programmable ones whose events occurred in this cycle. Decode collects
+    // the events and sends them along with every instruction or bubble.
+    void perf_count(bool nop) {
+        counter_increment(MCYCLE_I, MCYCLEH_I, 1);
+        if (!nop) {
+            // A fused pair retires two instructions, and so does a pair issued together
+            counter_increment(MINSTRET_I, MINSTRETH_I, (input.fused == 1 ? 2 : 1) + input.valid_1);
+        }
+        for (int i = 0; i < PRF_CNT_NUM; i++) {
+            if ((input.events & csr[MHPMEVENT_I + i].range(EVENT_NUM - 1, 0)) != 0) {
+                counter_increment(MHPMCOUNTER_I + i, MHPMCOUNTERH_I + i, 1);
+            }
+        }
+    }
+    
+    void counter_increment(sc_uint < CSR_IDX_LEN > low, sc_uint < CSR_IDX_LEN > high, sc_uint < 2 > amount) {
+        sc_uint < XLEN + 1 > sum = csr[low] + amount;
+        if (sum[XLEN] == 1) {
+            csr[high]++;
+        }
+        csr[low] = sum.range(XLEN - 1, 0);
+    }
+
+    #ifdef DUAL_ISSUE
+    // ALU of the second lane. Only the register-register operations: decode
+    // turns immediates and the pc into operands.
+    sc_uint < XLEN > lane1_alu(sc_uint < ALUOP_SIZE > alu_op, sc_int < XLEN > a, sc_int < XLEN > b) {
+        switch (alu_op) {
+        case ALUOP_ADD:
+            return (sc_uint < XLEN >) (a + b);
+        case ALUOP_SUB:
+            return (sc_uint < XLEN >) (a - b);
+        case ALUOP_SLL:
+            return (sc_uint < XLEN >) a << (sc_uint < SHAMT >) b.range(4, 0);
+        case ALUOP_SLT:
+            return (a < b) ? 1 : 0;
+        case ALUOP_SLTU:
+            return ((sc_uint < XLEN >) a < (sc_uint < XLEN >) b) ? 1 : 0;
+        case ALUOP_XOR:
+            return a ^ b;
+        case ALUOP_SRL:
+            return (sc_uint < XLEN >) a >> (sc_uint < SHAMT >) b.range(4, 0);
+        case ALUOP_SRA:
+            return a >> (sc_uint < SHAMT >) b.range(4, 0);
+        case ALUOP_OR:
+            return a | b;
+        case ALUOP_AND:
+            return a & b;
+            #ifdef ZICOND
+        case ALUOP_CZEROEQZ:
+            return (b == 0) ? (sc_uint < XLEN >) 0 : (sc_uint < XLEN >) a;
+        case ALUOP_CZERONEZ:
+            return (b != 0) ? (sc_uint < XLEN >) 0 : (sc_uint < XLEN >) a;
+            #endif
+        default:
+            return 0;
+        }
+    }
+    #endif
+
+    #ifdef BITMANIP
+    // Zba, Zbb and Zbs operations. For the immediate forms b is the sign extended
+    // immediate, whose low five bits hold the shift amount or the bit index.
+    sc_uint < XLEN > bitmanip(sc_uint < ALUOP_SIZE > alu_op, sc_uint < XLEN > a, sc_uint < XLEN > b) {
+        sc_uint < SHAMT > s = b.range(4, 0);
+        sc_uint < XLEN > bit = 1;
+        sc_uint < XLEN > res = 0;
+        bit = bit << s;
+
+        switch (alu_op) {
+        case ALUOP_SH1ADD:
+            return (a << 1) + b;
+        case ALUOP_SH2ADD:
+            return (a << 2) + b;
+        case ALUOP_SH3ADD:
+            return (a << 3) + b;
+        case ALUOP_ANDN:
+            return a & ~b;
+        case ALUOP_ORN:
+            return a | ~b;
+        case ALUOP_XNOR:
+            return ~(a ^ b);
+        case ALUOP_CLZ:
+            res = XLEN;
+            for (int i = 0; i < XLEN; i++) {
+                if (a[i] == 1) {
+                    res = XLEN - 1 - i;
+                }
+            }
+            return res;
+        case ALUOP_CTZ:
+            res = XLEN;
+            for (int i = XLEN - 1; i >= 0; i--) {
+                if (a[i] == 1) {
+                    res = i;
+                }
+            }
+            return res;
+        case ALUOP_CPOP:
+            for (int i = 0; i < XLEN; i++) {
+                res += a[i];
+            }
+            return res;
+        case ALUOP_MIN:
+            return ((sc_int < XLEN >) a < (sc_int < XLEN >) b) ? a : b;
+        case ALUOP_MINU:
+            return (a < b) ? a : b;
+        case ALUOP_MAX:
+            return ((sc_int < XLEN >) a < (sc_int < XLEN >) b) ? b : a;
+        case ALUOP_MAXU:
+            return (a < b) ? b : a;
+        case ALUOP_SEXTB:
+            return (sc_uint < XLEN >) (sc_int < XLEN >) (sc_int < 8 >) a.range(7, 0);
+        case ALUOP_SEXTH:
+            return (sc_uint < XLEN >) (sc_int < XLEN >) (sc_int < 16 >) a.range(15, 0);
+        case ALUOP_ZEXTH:
+            return a.range(15, 0);
+        case ALUOP_REV8:
+            for (int i = 0; i < XLEN / 8; i++) {
+                res.range(XLEN - 1 - 8 * i, XLEN - 8 - 8 * i) = a.range(8 * i + 7, 8 * i);
+            }
+            return res;
+        case ALUOP_ORCB:
+            for (int i = 0; i < XLEN / 8; i++) {
+                if (a.range(8 * i + 7, 8 * i) != 0) {
+                    res.range(8 * i + 7, 8 * i) = 255;
+                }
+            }
+            return res;
+        case ALUOP_ROL:
+            return (s == 0) ? a : (sc_uint < XLEN >) ((a << s) | (a >> (XLEN - s)));
+        case ALUOP_ROR:
+            return (s == 0) ? a : (sc_uint < XLEN >) ((a >> s) | (a << (XLEN - s)));
+        case ALUOP_BSET:
+            return a | bit;
+        case ALUOP_BCLR:
+            return a & ~bit;
+        case ALUOP_BINV:
+            return a ^ bit;
+        case ALUOP_BEXT:
+            return a[s];
+        default:
+            return 0;
+        }
+    }
+    #endif
+
     // Sign extend immS.
     sc_uint < XLEN > sign_extend_imm_s(sc_uint < 12 > imm) {
         sc_uint <XLEN> imm_ext = 0;
@@ -647,7 +849,23 @@ SC_MODULE(execute) {
             return MINSTRET_I;
         case MHARTID_A:
             return MHARTID_I;
+        case MCYCLEH_A:
+        case CYCLEH_A:
+            return MCYCLEH_I;
+        case MINSTRETH_A:
+        case INSTRETH_A:
+            return MINSTRETH_I;
+        case CYCLE_A:
+            return MCYCLE_I;
+        case INSTRET_A:
+            return MINSTRET_I;
         default:
+            if (csr_addr >= MHPMCOUNTER3_A && csr_addr < MHPMCOUNTER3_A + PRF_CNT_NUM)
+                return MHPMCOUNTER_I + (csr_addr - MHPMCOUNTER3_A);
+            if (csr_addr >= MHPMCOUNTER3H_A && csr_addr < MHPMCOUNTER3H_A + PRF_CNT_NUM)
+                return MHPMCOUNTERH_I + (csr_addr - MHPMCOUNTER3H_A);
+            if (csr_addr >= MHPMEVENT3_A && csr_addr < MHPMEVENT3_A + PRF_CNT_NUM)
+                return MHPMEVENT_I + (csr_addr - MHPMEVENT3_A);
             return 6; // TODO: this is not ideal. I default unsupported CSRs to MARCHID as it's not a critical register.
         }
     }
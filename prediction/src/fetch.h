@@ -60,10 +60,15 @@ SC_MODULE(fetch) {
     ras_data_t ra_stack[RAS_ENTRIES];
     sc_uint < RAS_POINTER_SIZE > ras_pointer;
     sc_uint < RAS_POINTER_SIZE > tosp_pointer;
+    // The stack as decode sees it: right-path calls and returns only, in order.
+    ras_data_t ra_stack_dec[RAS_ENTRIES];
+    sc_uint < RAS_POINTER_SIZE > tosp_pointer_dec;
     
     sc_uint < PC_LEN > mispredictions;
     sc_uint < PC_LEN > correct_predictions;
-    sc_uint < PC_LEN > redirect_addr;
+    // Flipped on every redirect. Instructions are tagged with it so that decode
+    // can drop the ones still queued from the abandoned path.
+    sc_uint < 1 > epoch;
 	
 	sc_uint < DATA_SIZE > mem_dout;
     sc_uint < ICACHE_LINE > imem_data;
@@ -79,6 +84,13 @@ SC_MODULE(fetch) {
     icache_data_t cache_data[1][ICACHE_WAYS];
     icache_tag_t cache_tag[1][ICACHE_WAYS];
     
+    // Replacement state of each set (see REPL_* in defines.h). Lines stay in
+    // their way until evicted, only this word changes on a hit.
+    sc_uint < ICACHE_REPL_WIDTH > icache_repl[ICACHE_ENTRIES];
+    #if ICACHE_REPLACEMENT == REPL_RANDOM
+    sc_uint < 16 > icache_lfsr;
+    #endif
+    
     btb_data_t btb_data[BTB_ENTRIES];
     btb_out_t btb_out;
 
@@ -87,10 +99,43 @@ SC_MODULE(fetch) {
     sc_uint < ICACHE_OFFSET_WIDTH + 1 > offset;
     
     sc_uint < ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH > buffer_addr;
+    
+    #ifdef ICACHE_PREFETCH
+    // Prefetched lines wait here until fetch asks for them. Same layout as the
+    // staging buffer: bit 0 is the valid bit, the upper bits the line address.
+    sc_uint < ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH + 1 > prefetch_buffer_addr[PREFETCH_BUFFER_SIZE];
+    sc_uint < ICACHE_LINE > prefetch_buffer_instr[PREFETCH_BUFFER_SIZE];
+    
+    sc_uint < ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH > prefetch_addr; // Next line of the stream
+    sc_uint < ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH > prefetch_pending_addr;
+    sc_uint < ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH > last_miss_addr;
+    sc_uint < PREFETCH_DEGREE_WIDTH > prefetch_count; // Lines of the stream still to be requested
+    sc_uint < PREFETCH_ACCURACY_WIDTH > prefetch_accuracy;
+    bool prefetch_pending;
+    sc_uint < ICACHE_LINE > prefetch_line; // Outstanding prefetch, put together word by word
+    sc_uint < ICACHE_LINE_WORDS > prefetch_words;
+    
+    sc_uint < PC_LEN > useful_prefetches;
+    sc_uint < PC_LEN > useless_prefetches;
+    #endif
+	
+    // Line being refilled. Memory returns it one word per cycle, the word at the
+    // pc first, and fetch goes on as soon as the words it needs are in. The line
+    // enters the I$ once complete.
+    bool refill_valid;
+    sc_uint < ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH > refill_addr;
+    sc_uint < ICACHE_WAYS_WIDTH > refill_way;
+    sc_uint < ICACHE_LINE > refill_line;
+    sc_uint < ICACHE_LINE_WORDS > refill_words; // One bit per word that arrived
+    sc_uint < ICACHE_LINE_WORDS > imem_words; // Words of imem_data that are valid
+	
+    // Lower half of a 32-bit instruction that straddles two lines, kept while
+    // the next line is fetched.
+    bool straddle;
+    sc_uint < 16 > straddle_low;
+    sc_uint < PC_LEN > straddle_pc;
 	
     bool freeze;
-    bool hit_buffer;
-    int position;
 	
     SC_CTOR(fetch): imem_din("imem_din"),
     fetch_din("fetch_din"),
@@ -114,7 +159,6 @@ SC_MODULE(fetch) {
             tag = 0;
             index= 0;
             offset = 0;
-            position = 0;
 									
             trap = 0;
             trap_cause = NULL_CAUSE;
@@ -122,8 +166,9 @@ SC_MODULE(fetch) {
             
 			ras_pointer = 0;
 			tosp_pointer = 0;
+			tosp_pointer_dec = 0;
             
-            redirect_addr = 0;
+            epoch = 0;
 			freeze = false;
 			redirect = false;
             //  Init. pc to START_ADDRESS - 4 as on first fetch it will be incremented by
@@ -143,6 +188,55 @@ SC_MODULE(fetch) {
 			
 			mispredictions = 0;
 			correct_predictions = 0;
+			
+			for (n = 0; n < BTB_ENTRIES; n++) {
+				btb_data[n].valid = false;
+			}
+			
+			for (n = 0; n < RAS_ENTRIES; n++) {
+				ra_stack[n].valid = false;
+				ra_stack_dec[n].valid = false;
+			}
+			
+			straddle = false;
+			straddle_low = 0;
+			straddle_pc = 0;
+			
+			for (n = 0; n < ICACHE_ENTRIES; n++) {
+				icache_repl[n] = 0;
+				#if ICACHE_REPLACEMENT == REPL_LRU
+				for (l = 0; l < ICACHE_WAYS; l++) {
+					icache_repl[n].range(l*ICACHE_WAYS_WIDTH + ICACHE_WAYS_WIDTH - 1, l*ICACHE_WAYS_WIDTH) = l;
+				}
+				#endif
+			}
+			#if ICACHE_REPLACEMENT == REPL_RANDOM
+			icache_lfsr = 1;
+			#endif
+			
+			refill_valid = false;
+			refill_addr = 0;
+			refill_way = 0;
+			refill_line = 0;
+			refill_words = 0;
+			imem_words = 0;
+			
+			#ifdef ICACHE_PREFETCH
+			for (n = 0; n < PREFETCH_BUFFER_SIZE; n++) {
+				prefetch_buffer_addr[n] = 0;
+				prefetch_buffer_instr[n] = 0;
+			}
+			prefetch_addr = 0;
+			prefetch_pending_addr = 0;
+			last_miss_addr = 0;
+			prefetch_count = 0;
+			prefetch_accuracy = PREFETCH_THRESHOLD;
+			prefetch_pending = false;
+			prefetch_line = 0;
+			prefetch_words = 0;
+			useful_prefetches = 0;
+			useless_prefetches = 0;
+			#endif
             
             wait();
         }
@@ -151,8 +245,10 @@ SC_MODULE(fetch) {
         FETCH_BODY: while (true) {
             //sc_assert(sc_time_stamp().to_double() < 1500000);
 			
+			// Words of a refill or a prefetch still on their way
+			imem_collect(false);
+			
 			// step 1 fetch from memory/cache
-            hit_buffer = false;
             fe_out.pc = pc;
             
             unsigned int aligned_addr = pc >> 2;
@@ -198,7 +294,7 @@ SC_MODULE(fetch) {
 						if (icache_buffer_addr[n][m].range(ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH, 1) == buffer_addr && icache_buffer_addr[n][m].range(0, 0) == 1) {
 							icache_out.data = icache_buffer_instr[n][m];
 							icache_out.hit = true;
-							hit_buffer = true;
+							icache_repl[index] = icache_touch(icache_repl[index], m);
 						}
 					}
 				}
@@ -208,59 +304,101 @@ SC_MODULE(fetch) {
             {
 				case CACHE_HIT:
                     imem_data = icache_out.data;
-                    
-                    #pragma unroll yes
-					for (int i = 0; i < DATA_WIDTH; i++) {
-						int index = offset*DATA_WIDTH + i;
-						imem_data_offset[i] = imem_data[index];
-					}
-                    
-                    fe_out.instr_data = imem_data_offset;
+                    imem_words = (1 << ICACHE_LINE_WORDS) - 1;
+                    fe_out.icache_miss = 0;
                     break;
                 case CACHE_MISS:
 				                    
-                    imem_din.Push(imem_in);
-
-					imem_out = imem_dout.Pop();
-					
-                    imem_data = imem_out.instr_data;
-					#pragma unroll yes
-					for (int i = 0; i < DATA_WIDTH; i++) {
-						int index = offset*DATA_WIDTH + i;
-						imem_data_offset[i] = imem_data[index];
-					}
-					fe_out.instr_data = imem_data_offset;
-					
-					icache_buffer_addr[0][ICACHE_WAYS - 1].range(0, 0) = 1;
-					icache_buffer_addr[0][ICACHE_WAYS - 1].range(ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH, 1) = buffer_addr;
-					icache_buffer_instr[0][ICACHE_WAYS - 1] = imem_data;
+                    imem_data = icache_refill();
+                    fe_out.icache_miss = 1; // Counted by the performance monitor
                     
                     break;
                 default:
                     break;
             }
             
-			icache_write();
+			sc_uint < PC_LEN > fetch_pc = pc;
+			sc_uint < ICACHE_OFFSET_WIDTH + 1 > half = fetch_pc.range(ICACHE_OFFSET_WIDTH + 1, 1);
 			
-			//step2 read from backchannel (decode)
-			if (position == 1 && !redirect) {
-				fetch_in = fetch_din.Pop();
-				redirect_addr = fetch_in.address;
-			}else {
-				position = 1;
+			imem_data_offset = line_word(half);
+			fe_out.rvc = 0;
+			#ifdef RVC
+			if (straddle) {
+				// Upper half of the instruction that started at the end of the previous line
+				imem_data_offset = ((sc_uint<16>)imem_data_offset.range(15, 0), straddle_low);
+				pc = straddle_pc;
+				fe_out.pc = straddle_pc;
+				straddle = false;
+			} else if (imem_data_offset.range(1, 0) != 3) {
+				imem_data_offset = rvc_expand(imem_data_offset.range(15, 0));
+				fe_out.rvc = 1;
+			} else if (half == ICACHE_LINE / (DATA_WIDTH / 2) - 1) {
+				straddle_low = imem_data_offset.range(15, 0);
+				straddle_pc = pc;
+				straddle = true;
 			}
-			// step3 if instruction correct send it, update btb, ras and get new pc
-			if (redirect_addr == pc) {
+			#endif
+			fe_out.instr_data = imem_data_offset;
+			
+			#ifdef ICACHE_PREFETCH
+			prefetch_issue();
+			#endif
+			
+			//step2 read from backchannel (decode) without waiting: decode only
+			// reports predictor updates and redirects
+			redirect = false;
+			if (fetch_din.PopNB(fetch_in)) {
 				btb_write();
-				ras_write();				
+				ras_write();
+				if (fetch_in.redirect) { // a queued instruction was mispredicted, drop the current one and redirect
+					pc = fetch_in.address;
+					epoch = epoch + 1;
+					redirect = true;
+					straddle = false;
+				}
+			}
+			// step3 queue the instruction for decode and get the predicted pc
+			if (!redirect && straddle) {
+				// Only the lower half is here, the rest is at the start of the next line
+				pc = pc + 2;
+			} else if (!redirect) {
 				btb();
-				ras();
-				pc = (btb_out.btb_valid || btb_out.ras_valid) ? btb_out.bta : (ac_int < PC_LEN, false >)(pc + 4);
-				redirect = false;
+				ras(fe_out.rvc);
+				#ifdef STATIC_PREDICTION
+				static_prediction();
+				#endif
+				pc = (btb_out.btb_valid || btb_out.ras_valid || btb_out.static_valid) ? btb_out.bta : (ac_int < PC_LEN, false >)(pc + (fe_out.rvc == 1 ? 2 : 4));
+				fe_out.pred_pc = pc;
+				fe_out.epoch = epoch;
+				fe_out.valid_1 = false;
+				#ifdef DUAL_FETCH
+				// The next instruction is sent along when it sits entirely on the same line
+				// and the first one is not predicted taken. pc already points to it.
+				fetch_pc = pc;
+				half = fetch_pc.range(ICACHE_OFFSET_WIDTH + 1, 1);
+				if (fetch_pc == fe_out.pc + (fe_out.rvc == 1 ? 2 : 4) && fetch_pc.range(PC_LEN - 1, ICACHE_OFFSET_WIDTH + 2) == fe_out.pc.range(PC_LEN - 1, ICACHE_OFFSET_WIDTH + 2) && line_ready(imem_words, half)) {
+					imem_data_offset = line_word(half);
+					fe_out.rvc_1 = 0;
+					#ifdef RVC
+					if (imem_data_offset.range(1, 0) != 3) {
+						imem_data_offset = rvc_expand(imem_data_offset.range(15, 0));
+						fe_out.rvc_1 = 1;
+					}
+					#endif
+					if (fe_out.rvc_1 == 1 || half < ICACHE_LINE / (DATA_WIDTH / 2) - 1) {
+						btb();
+						ras(fe_out.rvc_1);
+						#ifdef STATIC_PREDICTION
+						static_prediction();
+						#endif
+						pc = (btb_out.btb_valid || btb_out.ras_valid || btb_out.static_valid) ? btb_out.bta : (ac_int < PC_LEN, false >)(pc + (fe_out.rvc_1 == 1 ? 2 : 4));
+						fe_out.instr_data_1 = imem_data_offset;
+						fe_out.pred_pc_1 = pc;
+						fe_out.valid_1 = true;
+					}
+				}
+				#endif
 				dout.Push(fe_out);
-			}else { // step4 if instruction incorrect, redirect
-				pc = redirect_addr;
-				redirect = true;
 			}
 			
 			#ifndef __SYNTHESIS__
@@ -275,13 +413,11 @@ SC_MODULE(fetch) {
     icache_out_t icache () {
 
         icache_out_t iout;
-        icache_tag_t tmp_tag;
-        icache_data_t tmp_data;
+        sc_uint < ICACHE_WAYS_WIDTH > hit_way = 0;
         iout.data = 0;
         iout.hit = false;
 
 		int i = 0;
-        int j = 0;
 
         for (i = 0; i < ICACHE_WAYS; i++) {
             cache_tag[0][i] = icache_tags[index][i];
@@ -289,59 +425,248 @@ SC_MODULE(fetch) {
 
             if ((tag == cache_tag[0][i].tag) && (cache_tag[0][i].valid)) {
                               
-                tmp_data = cache_data[0][i];
-                tmp_tag = cache_tag[0][i];
+                iout.data = cache_data[0][i].data;
                 iout.hit = true;
-                j = i;
+                hit_way = i;
 
             }
 
 		}
 		
-		for (i = ICACHE_WAYS - 1; i > 0; i--) {
-			if (iout.hit && i <= j) {
-				cache_data[0][i] = cache_data[0][i-1];
-				cache_tag[0][i] = cache_tag[0][i-1];
-			}
-				
-		}
-
         if (iout.hit) {
-			
-            cache_data[0][0] = tmp_data;
-            cache_tag[0][0] = tmp_tag;
-		}else {
-			tmp_data = cache_data[0][ICACHE_WAYS - 1];
-		}
-
-        iout.data = tmp_data.data;
+            icache_repl[index] = icache_touch(icache_repl[index], hit_way);
+        }
 
         return iout;
     }
     
-    void icache_write () {
-			
-        sc_uint < ICACHE_INDEX_WIDTH > write_index = icache_buffer_addr[1][0].range(ICACHE_INDEX_WIDTH, 1);
+    // Way of the set that a new line goes into: an invalid way if there is one,
+    // otherwise the one chosen by the replacement policy.
+    sc_uint < ICACHE_WAYS_WIDTH > icache_victim (sc_uint < ICACHE_INDEX_WIDTH > set) {
+        sc_uint < ICACHE_REPL_WIDTH > state = icache_repl[set];
+        sc_uint < ICACHE_WAYS_WIDTH > victim = 0;
         int i = 0;
-        for (i = 0; i < ICACHE_WAYS; i++) {                 
-
-			if (hit_buffer) {
-				icache_buffer_instr[0][i] = icache_buffer_instr[1][i];
-				icache_buffer_addr[0][i] = icache_buffer_addr[1][i];
-			}
-			icache_data[write_index][i].data = icache_buffer_instr[1][i];
-			icache_tags[write_index][i].valid = icache_buffer_addr[1][i].range(0,0);
-			icache_tags[write_index][i].tag = icache_buffer_addr[1][i].range(ICACHE_INDEX_WIDTH + ICACHE_TAG_WIDTH, 1 + ICACHE_INDEX_WIDTH);
+        
+        #if ICACHE_REPLACEMENT == REPL_LRU
+        // Least recently used way, the last of the order
+        victim = state.range(ICACHE_REPL_WIDTH - 1, ICACHE_REPL_WIDTH - ICACHE_WAYS_WIDTH);
+        #elif ICACHE_REPLACEMENT == REPL_TREE_PLRU
+        // Follow the tree from the root, node n keeps its bit at n - 1
+        sc_uint < ICACHE_WAYS_WIDTH + 1 > node = 1;
+        for (i = 0; i < ICACHE_WAYS_WIDTH; i++) {
+            node = node*2 + state[node - 1];
         }
-                      
-
+        victim = node - ICACHE_WAYS;
+        #elif ICACHE_REPLACEMENT == REPL_BIT_PLRU
+        // First way not accessed since the bits were last cleared
+        for (i = ICACHE_WAYS - 1; i >= 0; i--) {
+            if (state[i] == 0) {
+                victim = i;
+            }
+        }
+        #else
+        victim = icache_lfsr.range(ICACHE_WAYS_WIDTH - 1, 0);
+        icache_lfsr = ((sc_uint < 1 >) (icache_lfsr[0] ^ icache_lfsr[2] ^ icache_lfsr[3] ^ icache_lfsr[5]), (sc_uint < 15 >) icache_lfsr.range(15, 1));
+        #endif
+        
+        for (i = ICACHE_WAYS - 1; i >= 0; i--) {
+            if (!icache_tags[set][i].valid) {
+                victim = i;
+            }
+        }
+        
+        return victim;
+    }
+    
+    // Replacement state of a set after an access to the given way.
+    sc_uint < ICACHE_REPL_WIDTH > icache_touch (sc_uint < ICACHE_REPL_WIDTH > state, sc_uint < ICACHE_WAYS_WIDTH > way) {
+        sc_uint < ICACHE_REPL_WIDTH > next = state;
+        int i = 0;
+        
+        #if ICACHE_REPLACEMENT == REPL_LRU
+        // The way moves to the front, the ones ahead of it move back by one
+        bool found = false;
+        for (i = 0; i < ICACHE_WAYS; i++) {
+            if (!found && i > 0) {
+                next.range(i*ICACHE_WAYS_WIDTH + ICACHE_WAYS_WIDTH - 1, i*ICACHE_WAYS_WIDTH) = state.range(i*ICACHE_WAYS_WIDTH - 1, (i - 1)*ICACHE_WAYS_WIDTH);
+            }
+            if (state.range(i*ICACHE_WAYS_WIDTH + ICACHE_WAYS_WIDTH - 1, i*ICACHE_WAYS_WIDTH) == way) {
+                found = true;
+            }
+        }
+        next.range(ICACHE_WAYS_WIDTH - 1, 0) = way;
+        #elif ICACHE_REPLACEMENT == REPL_TREE_PLRU
+        // Every node on the path to the way points to the other half
+        sc_uint < ICACHE_WAYS_WIDTH + 1 > node = 1;
+        for (i = ICACHE_WAYS_WIDTH - 1; i >= 0; i--) {
+            next[node - 1] = !way[i];
+            node = node*2 + way[i];
+        }
+        #elif ICACHE_REPLACEMENT == REPL_BIT_PLRU
+        next[way] = 1;
+        if (((sc_uint < ICACHE_WAYS >) next.range(ICACHE_WAYS - 1, 0)).and_reduce()) {
+            next = 0;
+            next[way] = 1;
+        }
+        #endif
+        
+        return next;
+    }
+    
+    // Returns the 32 bits of the current line that start at the given halfword.
+    // Bits past the end of the line read as zero.
+    sc_uint < XLEN > line_word (sc_uint < ICACHE_OFFSET_WIDTH + 1 > half) {
+        sc_uint < XLEN > word = 0;
+        
+        #pragma unroll yes
+        for (int i = 0; i < DATA_WIDTH; i++) {
+            int index = half*(DATA_WIDTH / 2) + i;
+            if (index < ICACHE_LINE) {
+                word[i] = imem_data[index];
+            }
+        }
+        
+        return word;
+    }
+    
+    // The words holding the 32 bits at the given halfword are among words.
+    bool line_ready (sc_uint < ICACHE_LINE_WORDS > words, sc_uint < ICACHE_OFFSET_WIDTH + 1 > half) {
+        bool ready = false;
+        
+        #pragma unroll yes
+        for (int i = 0; i < ICACHE_LINE_WORDS; i++) {
+            if (i == (half >> 1)) {
+                ready = (words[i] == 1) && (half[0] == 0 || i == ICACHE_LINE_WORDS - 1 || words[(i + 1) % ICACHE_LINE_WORDS] == 1);
+            }
+        }
+        
+        return ready;
+    }
+    
+    // Brings the missing line from the refill in progress, the prefetch buffer
+    // or memory. Returns once the words of the instruction at the pc are in,
+    // the rest of a refill keeps arriving in later cycles.
+    sc_uint < ICACHE_LINE > icache_refill () {
+        sc_uint < PC_LEN > fetch_pc = pc;
+        sc_uint < ICACHE_OFFSET_WIDTH + 1 > half = fetch_pc.range(ICACHE_OFFSET_WIDTH + 1, 1);
+        int i = 0;
+        
+        if (!refill_valid || refill_addr != buffer_addr) {
+            // Memory answers in order, so whatever is on its way is taken first
+            for (i = 0; i < ICACHE_LINE_WORDS; i++) {
+                if (refill_valid) {
+                    imem_collect(true);
+                }
+            }
+            #ifdef ICACHE_PREFETCH
+            for (i = 0; i < ICACHE_LINE_WORDS; i++) {
+                if (prefetch_pending) {
+                    imem_collect(true);
+                }
+            }
+            #endif
+            
+            refill_valid = true;
+            refill_addr = buffer_addr;
+            refill_way = icache_victim(buffer_addr.range(ICACHE_INDEX_WIDTH - 1, 0));
+            refill_line = 0;
+            refill_words = 0;
+            
+            #ifdef ICACHE_PREFETCH
+            if (prefetch_lookup(refill_line)) {
+                refill_words = (1 << ICACHE_LINE_WORDS) - 1;
+                icache_install();
+            } else {
+                imem_din.Push(imem_in);
+            }
+            prefetch_start();
+            #else
+            imem_din.Push(imem_in);
+            #endif
+        }
+        
+        for (i = 0; i < ICACHE_LINE_WORDS; i++) {
+            if (refill_valid && !line_ready(refill_words, half)) {
+                imem_collect(true);
+            }
+        }
+        
+        imem_words = refill_words;
+        return refill_line;
+    }
+    
+    // Takes one word of the memory response stream, waiting for it if asked to.
+    // Memory answers in order, so the words of the line being refilled come
+    // before those of a prefetch requested after it.
+    bool imem_collect (bool wait_word) {
+        bool got = true;
+        int i = 0;
+        
+        if (wait_word) {
+            imem_out = imem_dout.Pop();
+        } else {
+            got = imem_dout.PopNB(imem_out);
+        }
+        
+        if (got && refill_valid) {
+            for (i = 0; i < ICACHE_LINE_WORDS; i++) {
+                if (i == imem_out.word) {
+                    refill_line.range(i*XLEN + XLEN - 1, i*XLEN) = imem_out.instr_data;
+                    refill_words[i] = 1;
+                }
+            }
+            if (refill_words.and_reduce()) {
+                icache_install();
+            }
+        }
+        #ifdef ICACHE_PREFETCH
+        else if (got) {
+            for (i = 0; i < ICACHE_LINE_WORDS; i++) {
+                if (i == imem_out.word) {
+                    prefetch_line.range(i*XLEN + XLEN - 1, i*XLEN) = imem_out.instr_data;
+                    prefetch_words[i] = 1;
+                }
+            }
+            if (prefetch_words.and_reduce()) {
+                prefetch_fill(prefetch_pending_addr, prefetch_line);
+                prefetch_pending = false;
+                prefetch_words = 0;
+            }
+        }
+        #endif
+        
+        return got;
+    }
+    
+    // Writes the refilled line into the way picked at the miss, and into the
+    // copies of that set in the staging buffer, which may have been read from
+    // the data array before the write landed.
+    void icache_install () {
+        sc_uint < ICACHE_INDEX_WIDTH > install_index = refill_addr.range(ICACHE_INDEX_WIDTH - 1, 0);
+        int n = 0;
+        
+        icache_data[install_index][refill_way].data = refill_line;
+        icache_tags[install_index][refill_way].tag = refill_addr.range(ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH - 1, ICACHE_INDEX_WIDTH);
+        icache_tags[install_index][refill_way].valid = true;
+        icache_repl[install_index] = icache_touch(icache_repl[install_index], refill_way);
+        
+        for (n = 0; n < ICACHE_BUFFER_SIZE; n++) {
+            if (icache_buffer_addr[n][0].range(ICACHE_INDEX_WIDTH, 1) == install_index) {
+                icache_buffer_addr[n][refill_way].range(ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH, 1) = refill_addr;
+                icache_buffer_addr[n][refill_way][0] = 1;
+                icache_buffer_instr[n][refill_way] = refill_line;
+            }
+        }
+        
+        refill_valid = false;
     }
     
     void btb () {     
         sc_uint < BTB_INDEX_WIDTH > next_index = pc.range(BTB_INDEX_WIDTH - 1 ,0).to_uint();
 		sc_uint < BTB_TAG_WIDTH > next_tag = pc.range(BTB_INDEX_WIDTH + BTB_TAG_WIDTH - 1, BTB_INDEX_WIDTH).to_uint();
         
-        if(next_tag == btb_data[next_index].tag && btb_data[next_index].prediction_data > WEAK_NON_TAKEN) {
+        btb_out.btb_hit = btb_data[next_index].valid && (next_tag == btb_data[next_index].tag);
+        if(btb_out.btb_hit && btb_data[next_index].prediction_data > WEAK_NON_TAKEN) {
             btb_out.bta = btb_data[next_index].bta;
             btb_out.btb_valid = true;
         }
@@ -358,11 +683,27 @@ SC_MODULE(fetch) {
 		btb_data_t data = btb_data[index];
         //check if tag or branch target address differ in branch target buffer
         if (fetch_in.btb_update) {
-            if(tag != data.tag || fetch_in.bta != data.bta) {
+            if(!data.valid || tag != data.tag || fetch_in.bta != data.bta) {
+                bool predicted_taken = false;
+                #ifdef STATIC_PREDICTION
+                // Without an entry fetch went by the direction of the branch
+                if (!data.valid || tag != data.tag) {
+                    predicted_taken = (fetch_in.bta < update_pc);
+                } else {
+                    predicted_taken = (data.prediction_data > WEAK_NON_TAKEN);
+                }
+                #endif
+                btb_data[index].valid = true;
                 btb_data[index].tag = tag;
                 btb_data[index].bta = fetch_in.bta;
+                #ifdef STATIC_PREDICTION
+                // Allocate in the direction just resolved, so that a backward branch that was
+                // statically predicted taken keeps being predicted taken on its next lookup.
+                btb_data[index].prediction_data = fetch_in.branch_taken ? WEAK_NON_TAKEN + 1 : WEAK_NON_TAKEN;
+                #else
                 btb_data[index].prediction_data = WEAK_NON_TAKEN;
-                if (fetch_in.branch_taken) {
+                #endif
+                if (fetch_in.branch_taken != predicted_taken) {
 					mispredictions++;
 				}    
                 
@@ -387,7 +728,31 @@ SC_MODULE(fetch) {
         }
 	}
 	
-	void ras() {
+	// Pre-decodes the fetched word when the BTB has no entry for it.
+	// JAL is always predicted taken and conditional branches are predicted
+	// taken only when their target is backwards (loop back-edges).
+	void static_prediction() {
+		sc_uint < OPCODE_SIZE > opcode = imem_data_offset.range(6, 2);
+		
+		btb_out.static_valid = false;
+		if (btb_out.btb_hit || btb_out.ras_valid) {
+			return;
+		}
+		
+		if (opcode == OPC_JAL) {
+			sc_uint < 21 > immjal_tmp = ((sc_uint<1>)imem_data_offset.range(31, 31), (sc_uint<8>)imem_data_offset.range(19, 12), (sc_uint<1>)imem_data_offset.range(20, 20), (sc_uint<10>)imem_data_offset.range(30, 21), (sc_uint<1>)(0));
+			btb_out.bta = sign_extend_jump(immjal_tmp) + (sc_uint < PC_LEN >) pc;
+			btb_out.static_valid = true;
+		} else if (opcode == OPC_BEQ && imem_data_offset[31] == 1) {
+			sc_uint < 13 > immbranch_tmp = ((sc_uint<1>)imem_data_offset.range(31, 31), (sc_uint<1>)imem_data_offset.range(7, 7), (sc_uint<6>)imem_data_offset.range(30, 25), (sc_uint<4>)imem_data_offset.range(11, 8), (sc_uint<1>)(0));
+			btb_out.bta = sign_extend_branch(immbranch_tmp) + (sc_uint < PC_LEN >) pc;
+			btb_out.static_valid = true;
+		}
+	}
+	
+	// Fetch runs ahead of decode, so a call pushes its return address as soon as
+	// it is fetched: a short callee's return may be fetched before decode sees the call.
+	void ras(sc_uint < 1 > rvc) {
 		
 		if (imem_data_offset.range(6, 2) == OPC_JALR && ra_stack[ras_pointer].valid) {
 			btb_out.ras_valid = true;
@@ -398,15 +763,317 @@ SC_MODULE(fetch) {
 		}else {
 			btb_out.ras_valid = false;
 		}
+		
+		if (imem_data_offset.range(6, 2) == OPC_JAL) {
+			ra_stack[tosp_pointer].pc = (sc_uint < PC_LEN >) pc + (rvc == 1 ? 2 : 4);
+			ra_stack[tosp_pointer].valid = true;
+			tosp_pointer = tosp_pointer + 1;
+			ras_pointer = tosp_pointer - 1;
+		}
 	}
 	
+	// Replays decode's calls and returns on its copy of the stack. A redirect
+	// restores the fetch stack from it, undoing the pushes and pops of the
+	// instructions fetched on the abandoned path.
 	void ras_write() {
+		sc_uint < RAS_POINTER_SIZE > ras_pointer_dec = tosp_pointer_dec - 1;
+		
 		if (fetch_in.ras_update) {
-			ra_stack[tosp_pointer].pc = fetch_in.pc + 4;
-			ra_stack[tosp_pointer].valid = true;
-			tosp_pointer = tosp_pointer + 1;
-			ras_pointer = tosp_pointer - 1;
+			ra_stack_dec[tosp_pointer_dec].pc = fetch_in.pc + (fetch_in.rvc == 1 ? 2 : 4);
+			ra_stack_dec[tosp_pointer_dec].valid = true;
+			tosp_pointer_dec = tosp_pointer_dec + 1;
+		} else if (fetch_in.ras_pop && ra_stack_dec[ras_pointer_dec].valid) {
+			ra_stack_dec[ras_pointer_dec].valid = false;
+			tosp_pointer_dec = tosp_pointer_dec - 1;
+		}
+		
+		if (fetch_in.redirect) {
+			for (int n = 0; n < RAS_ENTRIES; n++) {
+				ra_stack[n] = ra_stack_dec[n];
+			}
+			tosp_pointer = tosp_pointer_dec;
+			ras_pointer = tosp_pointer_dec - 1;
+		}
+	}
+	
+	#ifdef ICACHE_PREFETCH
+	// Stores the answer to the outstanding prefetch. A line that is pushed out
+	// of the buffer without having been used lowers the prefetch accuracy.
+	void prefetch_fill(sc_uint < ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH > line_addr, sc_uint < ICACHE_LINE > line) {
+		int n = PREFETCH_BUFFER_SIZE - 1;
+		
+		if (prefetch_buffer_addr[n][0] == 1) {
+			useless_prefetches++;
+			if (prefetch_accuracy > 0) {
+				prefetch_accuracy--;
+			}
+		}
+		
+		for (n = PREFETCH_BUFFER_SIZE - 1; n > 0; n--) {
+			prefetch_buffer_addr[n] = prefetch_buffer_addr[n-1];
+			prefetch_buffer_instr[n] = prefetch_buffer_instr[n-1];
+		}
+		
+		prefetch_buffer_addr[0].range(ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH, 1) = line_addr;
+		prefetch_buffer_addr[0][0] = 1;
+		prefetch_buffer_instr[0] = line;
+	}
+	
+	// Looks for the missing line in the prefetch buffer. A hit frees the entry,
+	// since the line moves into the I$ through the staging buffer.
+	bool prefetch_lookup(sc_uint < ICACHE_LINE > &line) {
+		bool hit = false;
+		int n = 0;
+		
+		for (n = 0; n < PREFETCH_BUFFER_SIZE; n++) {
+			if (prefetch_buffer_addr[n].range(ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH, 1) == buffer_addr && prefetch_buffer_addr[n][0] == 1) {
+				line = prefetch_buffer_instr[n];
+				prefetch_buffer_addr[n][0] = 0;
+				hit = true;
+			}
+		}
+		
+		if (hit) {
+			useful_prefetches++;
+			if (prefetch_accuracy < PREFETCH_ACCURACY_MAX) {
+				prefetch_accuracy++;
+			}
+		}
+		
+		return hit;
+	}
+	
+	// Restarts the stream after the line that just missed. The accuracy decides
+	// how far ahead to run: not at all, the next line only, or PREFETCH_DEGREE lines.
+	void prefetch_start() {
+		// Two sequential misses while prefetching is throttled off show that it
+		// would have helped, otherwise the throttle could never reopen.
+		if (prefetch_accuracy == 0 && buffer_addr == last_miss_addr + 1) {
+			prefetch_accuracy = 1;
+		}
+		last_miss_addr = buffer_addr;
+		prefetch_addr = buffer_addr + 1;
+		
+		if (prefetch_accuracy == 0) {
+			prefetch_count = 0;
+		} else if (prefetch_accuracy < PREFETCH_THRESHOLD) {
+			prefetch_count = 1;
+		} else {
+			prefetch_count = PREFETCH_DEGREE;
+		}
+	}
+	
+	// Requests the next line of the stream if no prefetch is outstanding. Lines
+	// already held in the I$ or in the prefetch buffer are skipped.
+	void prefetch_issue() {
+		if (!prefetch_pending && prefetch_count > 0) {
+			sc_uint < ICACHE_INDEX_WIDTH > prefetch_index = prefetch_addr.range(ICACHE_INDEX_WIDTH - 1, 0);
+			sc_uint < ICACHE_TAG_WIDTH > prefetch_tag = prefetch_addr.range(ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH - 1, ICACHE_INDEX_WIDTH);
+			bool present = false;
+			int i = 0;
+			
+			for (i = 0; i < ICACHE_WAYS; i++) {
+				if (icache_tags[prefetch_index][i].tag == prefetch_tag && icache_tags[prefetch_index][i].valid) {
+					present = true;
+				}
+			}
+			for (i = 0; i < PREFETCH_BUFFER_SIZE; i++) {
+				if (prefetch_buffer_addr[i].range(ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH, 1) == prefetch_addr && prefetch_buffer_addr[i][0] == 1) {
+					present = true;
+				}
+			}
+			
+			imem_in_t prefetch_in;
+			prefetch_in.instr_addr = 0;
+			prefetch_in.instr_addr.range(ICACHE_TAG_WIDTH + ICACHE_INDEX_WIDTH + ICACHE_OFFSET_WIDTH - 1, ICACHE_OFFSET_WIDTH) = prefetch_addr;
+			
+			if (present || imem_din.PushNB(prefetch_in)) {
+				prefetch_pending = !present;
+				prefetch_pending_addr = prefetch_addr;
+				prefetch_addr = prefetch_addr + 1;
+				prefetch_count = prefetch_count - 1;
+			}
+		}
+	}
+	#endif
+	
+	#ifdef RVC
+	// Encoders for the 32-bit formats the compressed instructions expand to.
+	// Opcodes are given without their two LSBs, as in globals.h.
+	sc_uint < XLEN > rvc_itype(sc_uint < 12 > imm, sc_uint < 5 > rs1, sc_uint < FUNCT3_SIZE > funct3, sc_uint < 5 > rd, sc_uint < OPCODE_SIZE > opcode) {
+		sc_uint < XLEN > insn = (imm, rs1, funct3, rd, opcode, (sc_uint<2>)(3));
+		return insn;
+	}
+	
+	sc_uint < XLEN > rvc_rtype(sc_uint < FUNCT7_SIZE > funct7, sc_uint < 5 > rs2, sc_uint < 5 > rs1, sc_uint < FUNCT3_SIZE > funct3, sc_uint < 5 > rd) {
+		sc_uint < XLEN > insn = (funct7, rs2, rs1, funct3, rd, (sc_uint<OPCODE_SIZE>)(OPC_ADD), (sc_uint<2>)(3));
+		return insn;
+	}
+	
+	sc_uint < XLEN > rvc_stype(sc_uint < 12 > imm, sc_uint < 5 > rs2, sc_uint < 5 > rs1) {
+		sc_uint < XLEN > insn = ((sc_uint<7>)imm.range(11, 5), rs2, rs1, (sc_uint<FUNCT3_SIZE>)(FUNCT3_SW), (sc_uint<5>)imm.range(4, 0), (sc_uint<OPCODE_SIZE>)(OPC_SW), (sc_uint<2>)(3));
+		return insn;
+	}
+	
+	sc_uint < XLEN > rvc_btype(sc_uint < 13 > imm, sc_uint < 5 > rs1, sc_uint < FUNCT3_SIZE > funct3) {
+		sc_uint < XLEN > insn = ((sc_uint<1>)imm.range(12, 12), (sc_uint<6>)imm.range(10, 5), (sc_uint<5>)(0), rs1, funct3, (sc_uint<4>)imm.range(4, 1), (sc_uint<1>)imm.range(11, 11), (sc_uint<OPCODE_SIZE>)(OPC_BEQ), (sc_uint<2>)(3));
+		return insn;
+	}
+	
+	sc_uint < XLEN > rvc_jtype(sc_uint < 21 > imm, sc_uint < 5 > rd) {
+		sc_uint < XLEN > insn = ((sc_uint<1>)imm.range(20, 20), (sc_uint<10>)imm.range(10, 1), (sc_uint<1>)imm.range(11, 11), (sc_uint<8>)imm.range(19, 12), rd, (sc_uint<OPCODE_SIZE>)(OPC_JAL), (sc_uint<2>)(3));
+		return insn;
+	}
+	
+	// Expands a compressed instruction into the RV32I instruction it stands for,
+	// so that nothing past fetch needs to know about the C extension. Reserved
+	// and floating-point encodings turn into an all-ones word, which decode
+	// rejects as an illegal instruction.
+	sc_uint < XLEN > rvc_expand(sc_uint < 16 > c) {
+		sc_uint < XLEN > insn = RVC_ILLEGAL;
+		
+		sc_uint < 5 > rd = c.range(11, 7);
+		sc_uint < 5 > rs2 = c.range(6, 2);
+		sc_uint < 5 > rd_p = ((sc_uint<2>)(1), (sc_uint<3>)c.range(4, 2)); // x8-x15
+		sc_uint < 5 > rs1_p = ((sc_uint<2>)(1), (sc_uint<3>)c.range(9, 7));
+		sc_uint < 5 > shamt = c.range(6, 2);
+		
+		sc_uint < 12 > imm6 = ((sc_uint<7>)(c[12] ? 127 : 0), (sc_uint<5>)c.range(6, 2));
+		sc_uint < 12 > addi4spn_imm = ((sc_uint<2>)(0), (sc_uint<4>)c.range(10, 7), (sc_uint<2>)c.range(12, 11), (sc_uint<1>)c.range(5, 5), (sc_uint<1>)c.range(6, 6), (sc_uint<2>)(0));
+		sc_uint < 12 > lw_imm = ((sc_uint<5>)(0), (sc_uint<1>)c.range(5, 5), (sc_uint<3>)c.range(12, 10), (sc_uint<1>)c.range(6, 6), (sc_uint<2>)(0));
+		sc_uint < 12 > lwsp_imm = ((sc_uint<4>)(0), (sc_uint<2>)c.range(3, 2), (sc_uint<1>)c.range(12, 12), (sc_uint<3>)c.range(6, 4), (sc_uint<2>)(0));
+		sc_uint < 12 > swsp_imm = ((sc_uint<4>)(0), (sc_uint<2>)c.range(8, 7), (sc_uint<4>)c.range(12, 9), (sc_uint<2>)(0));
+		sc_uint < 12 > addi16sp_imm = ((sc_uint<3>)(c[12] ? 7 : 0), (sc_uint<2>)c.range(4, 3), (sc_uint<1>)c.range(5, 5), (sc_uint<1>)c.range(2, 2), (sc_uint<1>)c.range(6, 6), (sc_uint<4>)(0));
+		sc_uint < 20 > lui_imm = ((sc_uint<15>)(c[12] ? 32767 : 0), (sc_uint<5>)c.range(6, 2));
+		sc_uint < 21 > j_imm = ((sc_uint<10>)(c[12] ? 1023 : 0), (sc_uint<1>)c.range(8, 8), (sc_uint<2>)c.range(10, 9), (sc_uint<1>)c.range(6, 6), (sc_uint<1>)c.range(7, 7), (sc_uint<1>)c.range(2, 2), (sc_uint<1>)c.range(11, 11), (sc_uint<3>)c.range(5, 3), (sc_uint<1>)(0));
+		sc_uint < 13 > b_imm = ((sc_uint<5>)(c[12] ? 31 : 0), (sc_uint<2>)c.range(6, 5), (sc_uint<1>)c.range(2, 2), (sc_uint<2>)c.range(11, 10), (sc_uint<2>)c.range(4, 3), (sc_uint<1>)(0));
+		
+		sc_uint < 5 > sel = ((sc_uint<2>)c.range(1, 0), (sc_uint<3>)c.range(15, 13));
+		
+		switch (sel) {
+		case RVC_ADDI4SPN:
+			if (addi4spn_imm != 0) {
+				insn = rvc_itype(addi4spn_imm, 2, FUNCT3_ADDI, rd_p, OPC_ADDI);
+			}
+			break;
+		case RVC_LW:
+			insn = rvc_itype(lw_imm, rs1_p, FUNCT3_LW, rd_p, OPC_LW);
+			break;
+		case RVC_SW:
+			insn = rvc_stype(lw_imm, rd_p, rs1_p);
+			break;
+		case RVC_ADDI: // C.NOP when rd is x0
+			insn = rvc_itype(imm6, rd, FUNCT3_ADDI, rd, OPC_ADDI);
+			break;
+		case RVC_JAL:
+			insn = rvc_jtype(j_imm, 1);
+			break;
+		case RVC_LI:
+			insn = rvc_itype(imm6, 0, FUNCT3_ADDI, rd, OPC_ADDI);
+			break;
+		case RVC_LUI: // C.ADDI16SP when rd is x2
+			if (rd == 2 && addi16sp_imm != 0) {
+				insn = rvc_itype(addi16sp_imm, 2, FUNCT3_ADDI, 2, OPC_ADDI);
+			} else if (rd != 2 && lui_imm != 0) {
+				insn = (lui_imm, rd, (sc_uint<OPCODE_SIZE>)(OPC_LUI), (sc_uint<2>)(3));
+			}
+			break;
+		case RVC_MISC_ALU:
+			switch (c.range(11, 10)) {
+			case 0: // C.SRLI
+				if (c[12] == 0) {
+					insn = rvc_itype(shamt, rs1_p, FUNCT3_SRLI, rs1_p, OPC_SRLI);
+				}
+				break;
+			case 1: // C.SRAI
+				if (c[12] == 0) {
+					insn = rvc_itype(((sc_uint<7>)(FUNCT7_SRAI), shamt), rs1_p, FUNCT3_SRAI, rs1_p, OPC_SRAI);
+				}
+				break;
+			case 2: // C.ANDI
+				insn = rvc_itype(imm6, rs1_p, FUNCT3_ANDI, rs1_p, OPC_ANDI);
+				break;
+			default: // C.SUB, C.XOR, C.OR, C.AND
+				if (c[12] == 0) {
+					switch (c.range(6, 5)) {
+					case 0:
+						insn = rvc_rtype(FUNCT7_SUB, rd_p, rs1_p, FUNCT3_SUB, rs1_p);
+						break;
+					case 1:
+						insn = rvc_rtype(FUNCT7_XOR, rd_p, rs1_p, FUNCT3_XOR, rs1_p);
+						break;
+					case 2:
+						insn = rvc_rtype(FUNCT7_OR, rd_p, rs1_p, FUNCT3_OR, rs1_p);
+						break;
+					default:
+						insn = rvc_rtype(FUNCT7_AND, rd_p, rs1_p, FUNCT3_AND, rs1_p);
+						break;
+					}
+				}
+				break;
+			}
+			break;
+		case RVC_J:
+			insn = rvc_jtype(j_imm, 0);
+			break;
+		case RVC_BEQZ:
+			insn = rvc_btype(b_imm, rs1_p, FUNCT3_BEQ);
+			break;
+		case RVC_BNEZ:
+			insn = rvc_btype(b_imm, rs1_p, FUNCT3_BNE);
+			break;
+		case RVC_SLLI:
+			if (c[12] == 0) {
+				insn = rvc_itype(shamt, rd, FUNCT3_SLLI, rd, OPC_SLLI);
+			}
+			break;
+		case RVC_LWSP:
+			if (rd != 0) {
+				insn = rvc_itype(lwsp_imm, 2, FUNCT3_LW, rd, OPC_LW);
+			}
+			break;
+		case RVC_JR_MV_ADD:
+			if (c[12] == 0 && rs2 == 0) { // C.JR
+				if (rd != 0) {
+					insn = rvc_itype(0, rd, FUNCT3_JALR, 0, OPC_JALR);
+				}
+			} else if (c[12] == 0) { // C.MV
+				insn = rvc_rtype(FUNCT7_ADD, rs2, 0, FUNCT3_ADD, rd);
+			} else if (rd == 0 && rs2 == 0) { // C.EBREAK
+				insn = rvc_itype(1, 0, FUNCT3_EBREAK, 0, OPC_EBREAK);
+			} else if (rs2 == 0) { // C.JALR
+				insn = rvc_itype(0, rd, FUNCT3_JALR, 1, OPC_JALR);
+			} else { // C.ADD
+				insn = rvc_rtype(FUNCT7_ADD, rs2, rd, FUNCT3_ADD, rd);
+			}
+			break;
+		case RVC_SWSP:
+			insn = rvc_stype(swsp_imm, rs2, 2);
+			break;
+		default:
+			break;
+		}
+		
+		return insn;
+	}
+	#endif
+	
+	// Sign extend UJ insn.
+	sc_uint < PC_LEN > sign_extend_jump(sc_uint < 21 > imm) {
+		sc_uint < PC_LEN > ext_imm = imm;
+		if (imm[20] == 1) {
+			ext_imm.range(PC_LEN - 1, 21) = ~((sc_uint < PC_LEN - 21 >) 0);
+		}
+		return ext_imm;
+	}
+	
+	// Sign extend branch insn.
+	sc_uint < PC_LEN > sign_extend_branch(sc_uint < 13 > imm) {
+		sc_uint < PC_LEN > ext_imm = imm;
+		if (imm[12] == 1) {
+			ext_imm.range(PC_LEN - 1, 13) = ~((sc_uint < PC_LEN - 13 >) 0);
 		}
+		return ext_imm;
 	}
 };
 
@@ -19,7 +19,7 @@
 #define DMEM_SIZE   2048    // Size of data memory
 #define DATA_SIZE   32      // Size of data in DMEM   // CONST
 #define PC_LEN      32      // Width of PC register
-#define ALUOP_SIZE  5       // Size of aluop signal.
+#define ALUOP_SIZE  6       // Size of aluop signal.
 #define ALUSRC_SIZE 2       // Size of alusrc signal.
 #define BYTE        8       // 8-bits.
 #define ZIMM_SIZE   5       // Bit-length of zimm field in CSRRWI, CSRRSI, CSRRCI
@@ -27,9 +27,9 @@
 
 // Values for CSR and traps
 #define LOG2_NUM_CAUSES 3   // Log2 of number of trap causes
-#define CSR_NUM         11  // Number of CSR registers (including Performance Counters).
-#define CSR_IDX_LEN     4   // Log2 of CSR_NUM      // TODO: this should be rewritten into something like log2(CSR_NUM)
-#define PRF_CNT_NUM     1   // Number of Performance Counters.
+#define CSR_NUM         (13 + 3 * PRF_CNT_NUM)  // Number of CSR registers (including Performance Counters).
+#define CSR_IDX_LEN     5   // Log2 of CSR_NUM      // TODO: this should be rewritten into something like log2(CSR_NUM)
+#define PRF_CNT_NUM     HPM_COUNTERS   // Number of Performance Counters.
 #define CSR_ADDR        12  // CSRs are on a 12-bit addressing space.
 #define LOG2_CSR_OP_NUM 2   // Log2 of number of operations on CSR.
 #define CSR_OP_WR       1   // CSR write operation.
@@ -131,6 +131,10 @@
 #define OPC_CSRRSI   OPC_SYSTEM
 #define OPC_CSRRCI   OPC_SYSTEM
 
+#define OPC_AMO     11         // Original value is 47, but we trim the opcode's LSBs which are statically at 2'b11 for all instructions.
+#define OPC_LR      OPC_AMO
+#define OPC_SC      OPC_AMO
+
 /* Funct3 as integers. For control word generation switch case. */
 #define FUNCT3_ADD  0
 #define FUNCT3_SLL  1
@@ -217,9 +221,50 @@
 #define FUNCT7_SRLI     FUNCT7_SLLI
 #define FUNCT7_SRAI     32
 
+// Bit-manipulation extensions. Their immediate forms share the funct7 of the register ones.
+#define FUNCT7_SHADD    16  // SH1ADD, SH2ADD, SH3ADD
+#define FUNCT7_ANDN     FUNCT7_SUB  // ANDN, ORN, XNOR
+#define FUNCT7_MINMAX   5   // MIN, MINU, MAX, MAXU
+#define FUNCT7_ZEXTH    4
+#define FUNCT7_ROT      48  // ROL, ROR, RORI and the unary CLZ, CTZ, CPOP, SEXT.B, SEXT.H
+#define FUNCT7_BCLR     36  // BCLR, BEXT
+#define FUNCT7_BINV     52  // BINV and the unary REV8
+#define FUNCT7_BSET     20  // BSET and the unary ORC.B
+#define UNARY_CLZ       0   // rs2 field of the unary operations
+#define UNARY_CTZ       1
+#define UNARY_CPOP      2
+#define UNARY_SEXTB     4
+#define UNARY_SEXTH     5
+#define UNARY_REV8      24
+#define UNARY_ORCB      7
+
+// Integer conditional operations
+#define FUNCT7_CZERO    7
+#define FUNCT3_CZEROEQZ 5
+#define FUNCT3_CZERONEZ 7
+
 #define FUNCT7_EBREAK	0	// Note: strictly speaking ebreak and ecall don't have a funct7 field, but their [31-20] bits
 #define FUNCT7_ECALL	1	// are used to distinguish between them. I call these FUNCT7 for the sake of modularity.
 
+/* Compressed instructions as integers: quadrant (bits [1:0]) followed by funct3 (bits [15:13]). */
+#define RVC_ADDI4SPN    0
+#define RVC_LW          2
+#define RVC_SW          6
+#define RVC_ADDI        8
+#define RVC_JAL         9
+#define RVC_LI          10
+#define RVC_LUI         11      // Also C.ADDI16SP
+#define RVC_MISC_ALU    12      // C.SRLI, C.SRAI, C.ANDI, C.SUB, C.XOR, C.OR, C.AND
+#define RVC_J           13
+#define RVC_BEQZ        14
+#define RVC_BNEZ        15
+#define RVC_SLLI        16
+#define RVC_LWSP        18
+#define RVC_JR_MV_ADD   20      // Also C.JALR and C.EBREAK
+#define RVC_SWSP        22
+
+#define RVC_ILLEGAL     0xFFFFFFFF  // Expansion of reserved and unsupported compressed encodings
+
 /* ALUOPS */
 #define ALUOP_NULL      0
 
@@ -267,6 +312,39 @@
 #define ALUOP_CSRRSI  29
 #define ALUOP_CSRRCI  30
 
+// Zba, Zbb and Zbs. The immediate forms use ALUSRC_IMM_I, whose low bits are the shift amount.
+#define ALUOP_SH1ADD  31
+#define ALUOP_SH2ADD  32
+#define ALUOP_SH3ADD  33
+#define ALUOP_ANDN    34
+#define ALUOP_ORN     35
+#define ALUOP_XNOR    36
+#define ALUOP_CLZ     37
+#define ALUOP_CTZ     38
+#define ALUOP_CPOP    39
+#define ALUOP_MIN     40
+#define ALUOP_MINU    41
+#define ALUOP_MAX     42
+#define ALUOP_MAXU    43
+#define ALUOP_SEXTB   44
+#define ALUOP_SEXTH   45
+#define ALUOP_ZEXTH   46
+#define ALUOP_REV8    47
+#define ALUOP_ORCB    48
+#define ALUOP_ROL     49
+#define ALUOP_ROR     50
+#define ALUOP_BSET    51
+#define ALUOP_BCLR    52
+#define ALUOP_BINV    53
+#define ALUOP_BEXT    54
+#define ALUOP_CZEROEQZ 55
+#define ALUOP_CZERONEZ 56
+
+/* Units producing results after the execute stage (exe_out_t.deferred, mem_out_t.late_unit) */
+#define UNIT_NONE 0
+#define UNIT_DIV  1
+#define UNIT_MUL  2
+
 /* ALU Source discrimination values */
 #define ALUSRC_RS2      0
 #define ALUSRC_IMM_I    1
@@ -286,6 +364,21 @@
 #define SH_STORE 1
 #define SW_STORE 2
 
+/* Atomic memory operations, the funct5 field of the AMO opcode (amo signal) */
+#define FUNCT3_AMOW 2   // Only the word width exists in RV32A
+#define AMO_NONE  31    // Not an atomic, the encoding is unused
+#define AMO_ADD   0
+#define AMO_SWAP  1
+#define AMO_LR    2
+#define AMO_SC    3
+#define AMO_XOR   4
+#define AMO_OR    8
+#define AMO_AND   12
+#define AMO_MIN   16
+#define AMO_MAX   20
+#define AMO_MINU  24
+#define AMO_MAXU  28
+
 /* Trap causes: see page 35 of RISC-V privileged ISA draft V1.10. */
 #define NULL_CAUSE      10  // 10 is actually reserved in the specs but we use it to indicate no cause.
 #define EBREAK_CAUSE    3
@@ -304,6 +397,15 @@
 #define MIMPID_A      0xF13
 #define MINSTRET_A    0xF02
 #define MHARTID_A     0xF14
+#define MCYCLEH_A     0xB80
+#define MINSTRETH_A   0xB82
+#define MHPMCOUNTER3_A  0xB03 // mhpmcounter3..3+PRF_CNT_NUM-1 follow each other,
+#define MHPMCOUNTER3H_A 0xB83 // and so do their upper halves
+#define MHPMEVENT3_A    0x323 // and their event selectors.
+#define CYCLE_A       0xC00 // Read-only user copies of the machine counters
+#define INSTRET_A     0xC02
+#define CYCLEH_A      0xC80
+#define INSTRETH_A    0xC82
 
 #define USTATUS_I     0
 #define MSTATUS_I     1
@@ -316,6 +418,27 @@
 #define MIMPID_I      8
 #define MINSTRET_I    9
 #define MHARTID_I     10
+#define MCYCLEH_I     11
+#define MINSTRETH_I   12
+#define MHPMCOUNTER_I  13
+#define MHPMCOUNTERH_I (MHPMCOUNTER_I + PRF_CNT_NUM)
+#define MHPMEVENT_I    (MHPMCOUNTERH_I + PRF_CNT_NUM)
+
+/* Performance monitor events. An mhpmevent register is a mask of these bits:
+   its counter goes up in every cycle in which one of the selected events occurs. */
+#define EVENT_NUM         7
+#define EV_ICACHE_MISS    0 // An instruction fetched after an I$ miss reaches decode
+#define EV_DCACHE_MISS    1 // A load misses in the D$
+#define EV_MISPREDICT     2 // Decode redirects fetch
+#define EV_DECODE_FREEZE  3 // Decode holds an instruction back, for any reason
+#define EV_DIV_BUSY       4 // A division is in the divider
+#define EV_LOAD_USE       5 // Decode waits for an operand that a load has not written back yet
+#define EV_BANK_CONFLICT  6 // The ALU lane is held back for lack of register file read ports
+
+/* Instruction pairs fused by decode */
+#define FUSE_NONE   0
+#define FUSE_UPPER  1 // LUI/AUIPC rd followed by ADDI, a load or JALR through rd
+#define FUSE_SHIFT  2 // SLLI rd by 1 to 3 followed by ADD rd with rd as a source
 
 #define CACHE_HIT true
 #define CACHE_MISS false
@@ -0,0 +1,1296 @@
+/*	
+	@author VLSI Lab, EE dept., Democritus University of Thrace
+
+	@brief Header file for memory stage.
+
+	@note Changes from HL5
+
+		- Use of HLSLibs connections for communication with the rest of the processor.
+
+		- Memory is outside of the processor
+
+		- Split from the writeback stage: the D$ access, the miss handling and the
+		  load alignment have a pipeline step of their own.
+
+*/
+
+#ifndef __MEMORY__H
+#define __MEMORY__H
+
+#ifndef __SYNTHESIS__
+    #include <sstream>
+#endif
+
+#ifndef NDEBUG
+    #include <iostream>
+    #define DPRINT(msg) std::cout << msg;
+#endif
+
+
+#include "drim4hls_datatypes.h"
+#include "defines.h"
+#include "globals.h"
+
+#include <mc_connections.h>
+
+SC_MODULE(memory) {
+    #ifndef __SYNTHESIS__
+    struct memory_out // TODO: fix all sizes
+    {
+        //
+        // Member declarations.
+        //		
+        unsigned int aligned_address;
+        sc_uint < XLEN > load_data;
+        sc_uint < XLEN > store_data;
+        std::string load;
+        std::string store;
+
+    }
+    memory_out_t;
+    #endif
+
+    // FlexChannel initiators
+    Connections::In < exe_out_t > CCS_INIT_S1(din);
+    Connections::In < dmem_out_t > CCS_INIT_S1(dmem_out);
+
+    Connections::Out < mem_out_t > CCS_INIT_S1(dout);
+    Connections::Out < dmem_in_t > CCS_INIT_S1(dmem_in);
+    Connections::Out < reg_forward_t > CCS_INIT_S1(fwd_mem);
+
+    // Clock and reset signals
+    sc_in < bool > CCS_INIT_S1(clk);
+    sc_in < bool > CCS_INIT_S1(rst);
+	
+    // Member variables
+    exe_out_t input;
+    dmem_in_t dmem_dout;
+    dmem_out_t dmem_din;
+    mem_out_t output;
+    reg_forward_t forward;
+
+    sc_uint < DATA_SIZE > mem_dout;
+    sc_uint < DCACHE_LINE > dmem_data;
+    sc_uint < XLEN > dmem_data_offset;
+    
+    dcache_data_t dcache_data[DCACHE_ENTRIES][DCACHE_WAYS];
+    dcache_tag_t dcache_tags[DCACHE_ENTRIES][DCACHE_WAYS];
+    dcache_out_t dcache_out;
+    
+    dcache_data_t cache_data[1][DCACHE_WAYS];
+    dcache_tag_t cache_tag[1][DCACHE_WAYS];
+    
+    // Replacement state of each set (see REPL_* in defines.h). Lines stay in
+    // their way until evicted, only this word changes on a hit.
+    sc_uint < DCACHE_REPL_WIDTH > dcache_repl[DCACHE_ENTRIES];
+    #if DCACHE_REPLACEMENT == REPL_RANDOM
+    sc_uint < 16 > dcache_lfsr;
+    #endif
+    // Way of the last lookup: the hit way, or on a miss the way to refill
+    sc_uint < DCACHE_WAYS_WIDTH > dcache_way;
+
+    sc_uint < DCACHE_TAG_WIDTH > tag;
+    sc_uint < DCACHE_INDEX_WIDTH > index;
+    sc_uint < DCACHE_OFFSET_WIDTH + 1 > offset;
+    
+    // Store buffer, oldest entry first. Bit 0 of the address is the valid bit,
+    // the upper bits hold the word address. The mask has one bit per byte.
+    sc_uint < XLEN + 1 > store_buffer_addr[STORE_BUFFER_SIZE];
+    sc_uint < XLEN > store_buffer_data[STORE_BUFFER_SIZE];
+    sc_uint < XLEN / BYTE > store_buffer_mask[STORE_BUFFER_SIZE];
+    
+    // Copy of the last set written to the D$. Reads and writes of dcache_data
+    // in consecutive cycles are not ordered (see hls_to_synth.tcl), so an access
+    // to the same set in the next cycle takes the data from here.
+    dcache_data_t last_set_data[DCACHE_WAYS];
+    sc_uint < DCACHE_INDEX_WIDTH > last_set_index;
+    bool last_set_valid;
+    
+    // Miss status holding registers, one per D$ miss in flight, indexed by the id
+    // sent with the request. Bit 0 of the address is the valid bit, the upper bits
+    // hold the word address. The line is put together here as its words arrive.
+    // A load keeps its destination here and, once its word is in, its result until
+    // decode gets it. The bytes of the stores queued before the load are saved
+    // with it, since the store buffer moves on meanwhile.
+    sc_uint < XLEN + 1 > mshr_addr[MSHR_NUM];
+    sc_uint < DCACHE_LINE > mshr_line[MSHR_NUM];
+    sc_uint < DCACHE_LINE_WORDS > mshr_words[MSHR_NUM]; // One bit per word of the line that arrived
+    sc_uint < DCACHE_OFFSET_WIDTH + 1 > mshr_offset[MSHR_NUM]; // Word of the line the load reads
+    bool mshr_load[MSHR_NUM]; // A load result is still to be sent to decode
+    bool mshr_done[MSHR_NUM]; // The load result is in mshr_data
+    sc_uint < 3 > mshr_ld[MSHR_NUM];
+    sc_uint < 5 > mshr_byte_index[MSHR_NUM];
+    sc_uint < REG_ADDR > mshr_dest[MSHR_NUM];
+    sc_uint < TAG_WIDTH > mshr_tag[MSHR_NUM];
+    sc_uint < XLEN > mshr_data[MSHR_NUM];
+    sc_uint < XLEN / BYTE > mshr_mask[MSHR_NUM];
+    bool mshr_prefetch[MSHR_NUM]; // The line was requested by the prefetcher
+    
+    // Write-back buffer of dirty lines evicted from the D$, oldest first. Bit 0 of
+    // the address is the valid bit, the upper bits hold the line address. Lines
+    // go to memory while no miss is in flight, and a miss looks here first.
+    sc_uint < DCACHE_TAG_WIDTH + DCACHE_INDEX_WIDTH + 1 > victim_buffer_addr[VICTIM_BUFFER_SIZE];
+    sc_uint < DCACHE_LINE > victim_buffer_data[VICTIM_BUFFER_SIZE];
+    
+    #ifdef DCACHE_PREFETCH
+    // Reference prediction table of the stride prefetcher, indexed by the PC of
+    // the load/store. An entry keeps the last word address, the stride between
+    // the last two and how many times in a row that stride was seen.
+    sc_uint < PC_LEN > rpt_pc[RPT_ENTRIES];
+    sc_uint < XLEN > rpt_addr[RPT_ENTRIES];
+    sc_uint < XLEN > rpt_stride[RPT_ENTRIES];
+    sc_uint < RPT_CONFIDENCE_WIDTH > rpt_confidence[RPT_ENTRIES];
+    
+    sc_uint < XLEN > prefetch_addr; // Word address waiting for an idle memory port
+    bool prefetch_valid;
+    
+    sc_uint < PC_LEN > useful_prefetches;
+    sc_uint < PC_LEN > useless_prefetches;
+    #endif
+    
+
+    #ifdef ATOMIC
+    // Reservation of the last LR.W. Bit 0 is the valid bit, the upper bits hold
+    // the word address. Any SC.W clears it.
+    sc_uint < XLEN + 1 > reservation;
+    #endif
+    
+    // Constructor
+    SC_CTOR(memory): din("din"), dout("dout"), dmem_in("dmem_in"), dmem_out("dmem_out"), fwd_mem("fwd_mem"),
+    clk("clk"), rst("rst") {
+        SC_THREAD(memory_th);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst, false);
+    }
+
+    void memory_th(void) {
+        MEMORY_RST: {
+            din.Reset();
+            dmem_out.Reset();
+
+            dout.Reset();
+            dmem_in.Reset();
+            fwd_mem.Reset();
+            // Write dummy data to writeback.
+            output.regfile_address = 0;
+            output.regfile_data = 0;
+            output.regwrite = 0;
+            output.tag = 0;
+            output.miss = 0;
+            output.late_regwrite = 0;
+            output.late_regfile_address = 0;
+            output.late_regfile_data = 0;
+            output.late_tag = 0;
+            output.late_unit = UNIT_NONE;
+            output.deferred = UNIT_NONE;
+            forward.ldst = true;
+            forward.tag = 0;
+            forward.regfile_data = 0;
+            forward.valid_1 = false;
+			
+			dcache_out.data = 0;
+            dcache_out.hit = false;
+			
+            dmem_data = 0;
+            dmem_data_offset = 0;
+            mem_dout = 0;
+            
+            tag = 0;
+            index = 0;
+            offset = 0;
+            
+            for (int n = 0; n < STORE_BUFFER_SIZE; n++) {
+                store_buffer_addr[n] = 0;
+                store_buffer_data[n] = 0;
+                store_buffer_mask[n] = 0;
+            }
+            last_set_index = 0;
+            last_set_valid = false;
+            
+            for (int n = 0; n < DCACHE_ENTRIES; n++) {
+                dcache_repl[n] = 0;
+                #if DCACHE_REPLACEMENT == REPL_LRU
+                for (int l = 0; l < DCACHE_WAYS; l++) {
+                    dcache_repl[n].range(l*DCACHE_WAYS_WIDTH + DCACHE_WAYS_WIDTH - 1, l*DCACHE_WAYS_WIDTH) = l;
+                }
+                #endif
+            }
+            #if DCACHE_REPLACEMENT == REPL_RANDOM
+            dcache_lfsr = 1;
+            #endif
+            dcache_way = 0;
+            
+            for (int n = 0; n < MSHR_NUM; n++) {
+                mshr_addr[n] = 0;
+                mshr_line[n] = 0;
+                mshr_words[n] = 0;
+                mshr_offset[n] = 0;
+                mshr_load[n] = false;
+                mshr_done[n] = false;
+                mshr_ld[n] = 0;
+                mshr_byte_index[n] = 0;
+                mshr_dest[n] = 0;
+                mshr_tag[n] = 0;
+                mshr_data[n] = 0;
+                mshr_mask[n] = 0;
+                mshr_prefetch[n] = false;
+            }
+            for (int n = 0; n < VICTIM_BUFFER_SIZE; n++) {
+                victim_buffer_addr[n] = 0;
+                victim_buffer_data[n] = 0;
+            }
+            
+            #ifdef DCACHE_PREFETCH
+            for (int n = 0; n < RPT_ENTRIES; n++) {
+                rpt_pc[n] = 0;
+                rpt_addr[n] = 0;
+                rpt_stride[n] = 0;
+                rpt_confidence[n] = 0;
+            }
+            prefetch_addr = 0;
+            prefetch_valid = false;
+            useful_prefetches = 0;
+            useless_prefetches = 0;
+            #endif
+            
+            #ifdef ATOMIC
+            reservation = 0;
+            #endif
+        }
+
+        #pragma hls_pipeline_init_interval 1
+        #pragma pipeline_stall_mode flush
+        MEMORY_BODY: while (true) {
+
+            // Get
+			input = din.Pop();
+			
+            #ifndef __SYNTHESIS__
+                memory_out_t.aligned_address = 0;
+                memory_out_t.load_data = 0;
+                memory_out_t.store_data = 0;
+                memory_out_t.load = "NO_LOAD";
+                memory_out_t.store = "NO_STORE";
+            #endif
+            
+            // Compute
+            // *** Memory access.
+			dmem_data = 0;
+			dmem_data_offset = 0;
+            // WARNING: only supporting aligned memory accesses
+            // Preprocess address
+			
+            unsigned int aligned_address = input.alu_res.to_uint();
+            sc_uint< 5 > byte_index = (sc_uint< 5 >)((aligned_address & 0x3) << 3);
+            sc_uint< 5 > halfword_index = (sc_uint< 5 >)((aligned_address & 0x2) << 3);
+
+            aligned_address = aligned_address >> 2;
+            sc_uint < BYTE > db = (sc_uint < BYTE >) 0;
+            sc_uint < 2 * BYTE > dh = (sc_uint < 2 * BYTE >) 0;
+            sc_uint < XLEN > dw = (sc_uint < XLEN >) 0;
+
+            // *** Store buffer.
+            // Stores are queued and reach the D$ in a later cycle without a load,
+            // oldest first. Loads take the bytes of queued stores to the same word,
+            // so the D$ sees a single access per cycle: the load or the oldest store.
+            sc_uint < XLEN > store_word = 0;
+            sc_uint < XLEN / BYTE > store_mask = 0;
+            
+            if (input.st != NO_STORE) { // a store is requested
+            
+                switch (input.st) { // STORE
+                case SB_STORE: // store 8 bits of rs2
+					
+					db.range(BYTE - 1, 0) = (sc_uint < BYTE >) input.mem_datain.range(BYTE - 1, 0);
+					store_word.range(BYTE + byte_index - 1, byte_index) = (sc_uint < BYTE >) db;
+					store_mask[byte_index >> 3] = 1;
+
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.store_data = db;
+                    memory_out_t.store = "SB_STORE";
+                    #endif
+					
+                    break;
+                case SH_STORE: // store 16 bits of rs2
+
+					dh.range(2*BYTE - 1, 0) = input.mem_datain.range(2*BYTE - 1, 0);
+					store_word.range(2 * BYTE + byte_index - 1, byte_index) = dh;
+					store_mask[byte_index >> 3] = 1;
+					store_mask[(byte_index >> 3) + 1] = 1;
+                    
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.store_data = dh;
+                    memory_out_t.store = "SH_STORE";
+                    #endif
+					
+                    break;
+                case SW_STORE: // store rs2
+                    dw = input.mem_datain;
+                    store_word = dw;
+                    store_mask = 15;
+
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.store_data = dw;
+                    memory_out_t.store = "SW_STORE";
+                    #endif
+					
+					break;
+                default:
+
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.store = "NO_STORE";
+                    #endif
+					
+                    break; // NO_STORE
+                }
+            }
+            
+            // *** Miss status holding registers.
+            // Memory returns lines one word per cycle, the word that missed first.
+            // A word is taken in a cycle without a load, before the oldest queued
+            // store tries the D$ again.
+            bool filled = false;
+            if (input.ld == NO_LOAD && dmem_out.PopNB(dmem_din)) {
+                mshr_fill(dmem_din.id, dmem_din.word, dmem_din.data_out);
+                filled = true;
+            }
+            
+            // *** Atomics.
+            // An AMO or a successful SC reads the word and writes the new value back
+            // into the D$ line in the same cycle. A failed SC does not access the D$.
+            #ifdef ATOMIC
+            bool amo = (input.ld != NO_LOAD && input.amo != AMO_NONE);
+            bool sc_fail = amo && input.amo == AMO_SC && !(reservation[0] == 1 && reservation.range(XLEN, 1) == (sc_uint < XLEN >) aligned_address);
+            bool amo_rmw = amo && input.amo != AMO_LR && !sc_fail;
+            #else
+            bool sc_fail = false;
+            bool amo_rmw = false;
+            #endif
+            
+            bool access_load = (input.ld != NO_LOAD) && !sc_fail;
+            bool access_store = (input.ld == NO_LOAD) && (store_buffer_addr[0][0] == 1);
+            // The oldest store has to reach the D$ now to make room for the new one
+            bool store_full = (input.st != NO_STORE) && (store_buffer_addr[STORE_BUFFER_SIZE - 1][0] == 1);
+            
+            sc_uint < XLEN > access_address = aligned_address;
+            if (access_store) {
+                access_address = store_buffer_addr[0].range(XLEN, 1);
+            }
+            
+            sc_uint < XLEN > addr = access_address;
+            
+            dcache_address(addr);
+
+            #ifndef __SYNTHESIS__
+            if (sc_uint < 3 > (input.ld) != NO_LOAD || sc_uint < 2 > (input.st) != NO_STORE) {
+                if (input.mem_datain.to_uint() == 0x11111111 ||
+                    input.mem_datain.to_uint() == 0x22222222 ||
+                    input.mem_datain.to_uint() == 0x11223344 ||
+                    input.mem_datain.to_uint() == 0x88776655 ||
+                    input.mem_datain.to_uint() == 0x12345678 ||
+                    input.mem_datain.to_uint() == 0x87654321) {
+                    std::stringstream stm;
+                    stm << hex << "D$ access here2 -> 0x" << aligned_address << ". Value: " << input.mem_datain.to_uint() << std::endl;
+                }
+                //sc_assert(aligned_address < DCACHE_SIZE);
+            }
+            #endif
+            
+            bool miss_pending = false; // The load waits for its line in an MSHR
+            bool drain_stall = false; // The oldest store stays queued until its line is back
+            bool load_miss = false; // For the performance monitor
+            
+			if (access_load || access_store) {
+                dcache_out = dcache();
+                
+                if (!dcache_out.hit && victim_buffer_restore(addr)) {
+                    dcache_out = dcache();
+                }
+                load_miss = access_load && !dcache_out.hit;
+				
+                if (!dcache_out.hit && access_store && !store_full) {
+                    // Request the line unless it is on its way, and retry later
+                    mshr_allocate(addr, false, 0, false);
+                    drain_stall = true;
+                } else if (!dcache_out.hit && access_load && !amo_rmw && mshr_allocate(addr, true, byte_index, false)) {
+                    // Hit under miss: the load completes when its line is back. An atomic
+                    // needs the line in this cycle and takes the blocking path below.
+                    miss_pending = true;
+                } else if (!dcache_out.hit) {
+                    // No MSHR can take the miss. Wait for the ones in flight, then
+                    // the line is the next response from memory.
+                    mshr_drain();
+                    dcache_address(addr);
+                    dcache_out = dcache();
+                    
+                    if (!dcache_out.hit) {
+                        dcache_evict();
+                        
+                        dmem_dout.data_addr = addr;
+                        dmem_dout.read_en = true;
+                        dmem_dout.write_en = false;
+                        dmem_dout.id = 0;
+                        dmem_in.Push(dmem_dout);
+					
+                        for (int i = 0; i < DCACHE_LINE_WORDS; i++) {
+                            dmem_din = dmem_out.Pop();
+                            for (int w = 0; w < DCACHE_LINE_WORDS; w++) {
+                                if (w == dmem_din.word) {
+                                    dmem_data.range(w*XLEN + XLEN - 1, w*XLEN) = dmem_din.data_out;
+                                }
+                            }
+                        }
+                        cache_data[0][dcache_way].data = dmem_data;
+                    }
+                }
+                
+                if (!miss_pending && !drain_stall) {
+                    dmem_data = cache_data[0][dcache_way].data;
+                    
+                    #pragma unroll yes
+					for (int i = 0; i < DATA_WIDTH; i++) {
+						int index_word = offset*DATA_WIDTH + i;
+						dmem_data_offset[i] = dmem_data[index_word];
+					}
+                }
+            }
+            
+            if (access_load && !miss_pending) { // a load is requested
+                
+                // Queued stores are younger than the D$ copy
+                sc_uint < XLEN / BYTE > forward_mask = 0;
+                store_buffer_forward(aligned_address, dmem_data_offset, forward_mask);
+                
+                switch (input.ld) { // LOAD
+                case LB_LOAD:                    
+                    db.range(BYTE - 1, 0) = dmem_data_offset.range(BYTE + byte_index - 1, byte_index);
+                    mem_dout = ext_sign_byte(db);
+
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.load_data = mem_dout;
+                    memory_out_t.load = "LB_LOAD";
+                    #endif
+
+                    break;
+                case LH_LOAD:
+                    dh.range(2*BYTE - 1, 0) = dmem_data_offset.range(2*BYTE + halfword_index - 1, halfword_index);
+                    mem_dout = ext_sign_halfword(dh);
+
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.load_data = mem_dout;
+                    memory_out_t.load = "LH_LOAD";
+                    #endif
+
+                    break;
+                case LW_LOAD:
+                    dw = dmem_data_offset;
+                    mem_dout = dw;
+
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.load_data = mem_dout;
+                    memory_out_t.load = "LW_LOAD";
+                    #endif
+
+                    break;
+                case LBU_LOAD:
+                    db.range(BYTE - 1, 0) = dmem_data_offset.range(BYTE + byte_index - 1, byte_index);
+                    mem_dout = ext_unsign_byte(db);
+
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.load_data = mem_dout;
+                    memory_out_t.load = "LBU_LOAD";
+                    #endif
+
+                    break;
+                case LHU_LOAD:
+                    dh.range(2 * BYTE - 1, 0) = dmem_data_offset.range(2 * BYTE + halfword_index - 1, halfword_index);
+                    mem_dout = ext_unsign_halfword(dh);
+
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.load_data = mem_dout;
+                    memory_out_t.load = "LHU_LOAD";
+                    #endif
+
+                    break;
+                default:
+
+                    #ifndef __SYNTHESIS__
+                    memory_out_t.load_data = mem_dout;
+                    memory_out_t.load = "NO_LOAD";
+                    #endif
+
+                    break; // NO_LOAD
+                }
+                
+                #ifdef ATOMIC
+                if (amo_rmw) {
+                    amo_write(mem_dout);
+                }
+                #endif
+            } else if (access_store && !drain_stall) { // the oldest queued store goes into the D$
+				
+				int i = 0;
+				for (i = 0; i < XLEN / BYTE; i++) {
+					if (store_buffer_mask[0][i] == 1) {
+						dmem_data_offset.range(BYTE * i + BYTE - 1, BYTE * i) = store_buffer_data[0].range(BYTE * i + BYTE - 1, BYTE * i);
+					}
+				}
+				
+                #pragma unroll yes
+				for (int i = 0; i < DATA_WIDTH; i++) {
+					int index_word = offset*DATA_WIDTH + i;
+					dmem_data[index_word] = dmem_data_offset[i];
+				}
+
+                dmem_dout.data_in = cache_data[0][dcache_way].data;
+                cache_data[0][dcache_way].data = dmem_data;
+                
+            }
+
+			if ((access_load && !miss_pending) || (access_store && !drain_stall)) {
+				#ifdef DCACHE_PREFETCH
+				if (dcache_out.hit && cache_tag[0][dcache_way].prefetched) {
+					useful_prefetches++;
+					cache_tag[0][dcache_way].prefetched = false;
+				}
+				#endif
+				dcache_write(!access_store && !amo_rmw, dcache_out.hit);
+			}
+			
+			store_buffer_update(access_store && !drain_stall, input.st != NO_STORE, aligned_address, store_word, store_mask);
+			
+			// Refills go first: the write-back buffer only gets the memory port
+			// when no line is on its way and memory takes the write right away.
+			if (victim_buffer_addr[0][0] == 1 && !mshr_outstanding()) {
+				victim_buffer_write(false);
+			}
+			#ifdef DCACHE_PREFETCH
+			// So does the prefetcher, after the buffer, and only in a cycle that
+			// left the D$ alone.
+			else if (prefetch_valid && !mshr_outstanding() && !access_load && !access_store && !filled) {
+				prefetch_issue();
+			}
+			
+			if (input.ld != NO_LOAD || input.st != NO_STORE) {
+				rpt_update(input.pc, aligned_address);
+			}
+			#endif
+			
+            #ifdef ATOMIC
+            if (amo && input.amo == AMO_LR) {
+                reservation.range(XLEN, 1) = aligned_address;
+                reservation[0] = 1;
+            } else if (amo && input.amo == AMO_SC) {
+                reservation = 0;
+            }
+            if (sc_fail) {
+                mem_dout = 1;
+            }
+            #endif
+            
+            // *** END of memory access.
+            
+            /* Result, written back in the next stage */
+            output.regwrite = (miss_pending || input.deferred != UNIT_NONE) ? (sc_uint < 1 >) 0 : input.regwrite;
+            output.regfile_address = input.dest_reg;
+            output.regfile_data = (input.memtoreg[0] == 1) ? mem_dout : input.alu_res;
+            output.tag = input.tag;
+            output.pc = input.pc;
+            output.miss = (miss_pending && input.regwrite == 1 && input.dest_reg != 0) || input.deferred != UNIT_NONE;
+            output.dcache_miss = load_miss;
+            output.deferred = input.deferred;
+            #ifdef DUAL_ISSUE
+            // Result of the ALU lane, in the same cycle as the instruction it was issued with
+            output.regwrite_1 = input.regwrite_1;
+            output.regfile_address_1 = input.dest_reg_1;
+            output.regfile_data_1 = input.alu_res_1;
+            output.tag_1 = input.tag_1;
+            #endif
+            mshr_report();
+            
+            // ALU results bypass the stage: decode takes them from here while the
+            // instruction is one step away from writeback. A load result is not
+            // forwarded, the D$ stays off decode's path.
+            forward.ldst = (input.regwrite == 0 || input.ld != NO_LOAD || input.deferred != UNIT_NONE);
+            forward.tag = input.tag;
+            forward.regfile_data = input.alu_res;
+            forward.pc = input.pc;
+            #ifdef DUAL_ISSUE
+            forward.valid_1 = (input.regwrite_1 == 1);
+            forward.tag_1 = input.tag_1;
+            forward.regfile_data_1 = input.alu_res_1;
+            #endif
+
+            // Put
+            fwd_mem.Push(forward);
+		    dout.Push(output);
+		    
+            #ifndef __SYNTHESIS__
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "load= " << memory_out_t.load << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "store= " << memory_out_t.store << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << std::hex << "input.regwrite=" << input.regwrite << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "regwrite=" << output.regwrite << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "aligned_address=" << aligned_address << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << std::hex << "mem_dout=" << mem_dout << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << std::hex << "input.alu_res=" << input.alu_res << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << std::hex << "output.regfile_address=" << output.regfile_address << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << std::hex << "output.regfile_data=" << output.regfile_data << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << std::hex << "input.memtoreg=" << input.memtoreg << endl);
+            DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << std::hex << "memory_out_t.store_data =" << memory_out_t.store_data  << endl);
+            DPRINT(endl);
+            #endif
+            wait();
+        }
+    }
+
+    /* Support functions */
+
+    // Sign extend byte read from memory. For LB
+    sc_uint < XLEN > ext_sign_byte(sc_uint < BYTE > read_data) {
+		sc_uint <XLEN > extended = 0;
+		if (read_data[7] == 1) {
+			extended.range(BYTE - 1, 0) = read_data;
+			extended.range(BYTE * 4 - 1, BYTE) = (sc_uint < BYTE * 3 >) 16777216;
+		}
+		else {
+			extended.range(BYTE - 1, 0) = read_data;
+			extended.range(BYTE * 4 - 1, BYTE) = (sc_uint < BYTE * 3 >) 0;	
+		}
+		return extended;
+    }
+
+    // Zero extend byte read from memory. For LBU
+    sc_uint < XLEN > ext_unsign_byte(sc_uint < BYTE > read_data) {
+		sc_uint <XLEN> extended = 0;
+		extended.range(BYTE - 1, 0) = read_data;
+		extended.range(BYTE * 4 - 1, BYTE) = (sc_uint < BYTE * 3 >) 0;	
+		return extended;        
+    }
+
+    // Sign extend half-word read from memory. For LH
+    sc_uint < XLEN > ext_sign_halfword(sc_uint < BYTE * 2 > read_data) {
+		sc_uint <XLEN> extended = 0;
+		        
+        if (read_data[15] == 1) {
+			extended.range(BYTE * 2 - 1, 0) = read_data;
+			extended.range(BYTE * 4 - 1, 2*BYTE) = (sc_uint < BYTE * 2 >) 65535;
+        }
+        else {
+			extended.range(BYTE * 2 - 1, 0) = read_data;
+			extended.range(BYTE * 4 - 1, 2*BYTE) = (sc_uint < BYTE * 2 >) 0;
+        }
+        return extended;
+    }
+
+    // Zero extend half-word read from memory. For LHU
+    sc_uint < XLEN > ext_unsign_halfword(sc_uint < BYTE * 2 > read_data) {
+		sc_uint <XLEN> extended = 0;
+		extended.range(BYTE * 2 - 1, 0) = read_data;
+		extended.range(BYTE * 4 - 1, 2*BYTE) = (sc_uint < BYTE * 2 >) 0;
+		return extended;
+    }
+    
+    // Splits a word address into the D$ tag, index and offset.
+    void dcache_address (sc_uint < XLEN > addr) {
+        tag = addr.range(DCACHE_INDEX_WIDTH + DCACHE_OFFSET_WIDTH + DCACHE_TAG_WIDTH - 1, DCACHE_INDEX_WIDTH + DCACHE_OFFSET_WIDTH);
+        index = addr.range(DCACHE_INDEX_WIDTH + DCACHE_OFFSET_WIDTH - 1, DCACHE_OFFSET_WIDTH);
+        if (DCACHE_OFFSET_WIDTH) {
+            offset = addr.range(DCACHE_OFFSET_WIDTH - 1, 0);
+        }
+        else {
+            offset = 0;
+        }
+    }
+    
+    dcache_out_t dcache () {
+
+        dcache_out_t dout;
+        dout.data = 0;
+        dout.hit = false;
+
+		int i = 0;
+
+        for (i = 0; i < DCACHE_WAYS; i++) {
+            cache_tag[0][i] = dcache_tags[index][i];
+            if (last_set_valid && last_set_index == index) {
+                cache_data[0][i] = last_set_data[i];
+            } else {
+                cache_data[0][i] = dcache_data[index][i];
+            }
+
+            if ((tag == cache_tag[0][i].tag) && (cache_tag[0][i].valid)) {
+                              
+                dout.data = cache_data[0][i].data;
+                dout.hit = true;
+                dcache_way = i;
+
+            }
+
+		}
+		
+        if (!dout.hit) {
+            dcache_way = dcache_victim();
+        }
+
+        return dout;
+    }
+    
+    // Way of the looked up set that a new line goes into: an invalid way if
+    // there is one, otherwise the one chosen by the replacement policy.
+    sc_uint < DCACHE_WAYS_WIDTH > dcache_victim () {
+        sc_uint < DCACHE_REPL_WIDTH > state = dcache_repl[index];
+        sc_uint < DCACHE_WAYS_WIDTH > victim = 0;
+        int i = 0;
+        
+        #if DCACHE_REPLACEMENT == REPL_LRU
+        // Least recently used way, the last of the order
+        victim = state.range(DCACHE_REPL_WIDTH - 1, DCACHE_REPL_WIDTH - DCACHE_WAYS_WIDTH);
+        #elif DCACHE_REPLACEMENT == REPL_TREE_PLRU
+        // Follow the tree from the root, node n keeps its bit at n - 1
+        sc_uint < DCACHE_WAYS_WIDTH + 1 > node = 1;
+        for (i = 0; i < DCACHE_WAYS_WIDTH; i++) {
+            node = node*2 + state[node - 1];
+        }
+        victim = node - DCACHE_WAYS;
+        #elif DCACHE_REPLACEMENT == REPL_BIT_PLRU
+        // First way not accessed since the bits were last cleared
+        for (i = DCACHE_WAYS - 1; i >= 0; i--) {
+            if (state[i] == 0) {
+                victim = i;
+            }
+        }
+        #else
+        victim = dcache_lfsr.range(DCACHE_WAYS_WIDTH - 1, 0);
+        dcache_lfsr = ((sc_uint < 1 >) (dcache_lfsr[0] ^ dcache_lfsr[2] ^ dcache_lfsr[3] ^ dcache_lfsr[5]), (sc_uint < 15 >) dcache_lfsr.range(15, 1));
+        #endif
+        
+        for (i = DCACHE_WAYS - 1; i >= 0; i--) {
+            if (!cache_tag[0][i].valid) {
+                victim = i;
+            }
+        }
+        
+        return victim;
+    }
+    
+    // Replacement state of a set after an access to the given way.
+    sc_uint < DCACHE_REPL_WIDTH > dcache_touch (sc_uint < DCACHE_REPL_WIDTH > state, sc_uint < DCACHE_WAYS_WIDTH > way) {
+        sc_uint < DCACHE_REPL_WIDTH > next = state;
+        int i = 0;
+        
+        #if DCACHE_REPLACEMENT == REPL_LRU
+        // The way moves to the front, the ones ahead of it move back by one
+        bool found = false;
+        for (i = 0; i < DCACHE_WAYS; i++) {
+            if (!found && i > 0) {
+                next.range(i*DCACHE_WAYS_WIDTH + DCACHE_WAYS_WIDTH - 1, i*DCACHE_WAYS_WIDTH) = state.range(i*DCACHE_WAYS_WIDTH - 1, (i - 1)*DCACHE_WAYS_WIDTH);
+            }
+            if (state.range(i*DCACHE_WAYS_WIDTH + DCACHE_WAYS_WIDTH - 1, i*DCACHE_WAYS_WIDTH) == way) {
+                found = true;
+            }
+        }
+        next.range(DCACHE_WAYS_WIDTH - 1, 0) = way;
+        #elif DCACHE_REPLACEMENT == REPL_TREE_PLRU
+        // Every node on the path to the way points to the other half
+        sc_uint < DCACHE_WAYS_WIDTH + 1 > node = 1;
+        for (i = DCACHE_WAYS_WIDTH - 1; i >= 0; i--) {
+            next[node - 1] = !way[i];
+            node = node*2 + way[i];
+        }
+        #elif DCACHE_REPLACEMENT == REPL_BIT_PLRU
+        next[way] = 1;
+        if (((sc_uint < DCACHE_WAYS >) next.range(DCACHE_WAYS - 1, 0)).and_reduce()) {
+            next = 0;
+            next[way] = 1;
+        }
+        #endif
+        
+        return next;
+    }
+    
+    // Writes back the way of the last lookup. The data array is left alone on
+    // a load hit, only the tag and the replacement state change.
+    void dcache_write (bool load, bool hit) {
+				
+        if (!(load && hit)) { 
+            cache_tag[0][dcache_way].tag = tag;
+            cache_tag[0][dcache_way].valid = true;
+        }
+
+        if (!load) {
+            cache_tag[0][dcache_way].dirty = true;
+        }else if (!hit){
+            cache_tag[0][dcache_way].dirty = false;
+        }
+        
+        if (!(load && hit)) {
+            dcache_data[index][dcache_way] = cache_data[0][dcache_way];
+        }
+        dcache_tags[index][dcache_way] = cache_tag[0][dcache_way];
+        dcache_repl[index] = dcache_touch(dcache_repl[index], dcache_way);
+        
+        int i = 0;
+        for (i = 0; i < DCACHE_WAYS; i++) {                 
+            last_set_data[i] = cache_data[0][i];
+        }      
+        last_set_index = index;
+        last_set_valid = true;
+
+    }
+    
+    // Moves the way picked by the last lookup to the write-back buffer if it is dirty,
+    // before a new line takes its place. A full buffer first writes its oldest
+    // line to memory.
+    void dcache_evict () {
+        bool placed = false;
+        int n = 0;
+        
+        #ifdef DCACHE_PREFETCH
+        if (cache_tag[0][dcache_way].prefetched) {
+            useless_prefetches++;
+        }
+        #endif
+        cache_tag[0][dcache_way].prefetched = false;
+        
+        if (cache_tag[0][dcache_way].dirty) {
+            if (victim_buffer_addr[VICTIM_BUFFER_SIZE - 1][0] == 1) {
+                victim_buffer_write(true);
+            }
+            for (n = 0; n < VICTIM_BUFFER_SIZE; n++) {
+                if (victim_buffer_addr[n][0] == 0 && !placed) {
+                    victim_buffer_addr[n].range(DCACHE_TAG_WIDTH + DCACHE_INDEX_WIDTH, DCACHE_INDEX_WIDTH + 1) = cache_tag[0][dcache_way].tag;
+                    victim_buffer_addr[n].range(DCACHE_INDEX_WIDTH, 1) = index;
+                    victim_buffer_addr[n][0] = 1;
+                    victim_buffer_data[n] = cache_data[0][dcache_way].data;
+                    placed = true;
+                }
+            }
+        }
+    }
+    
+    // Sends the oldest line of the write-back buffer to memory, which does not
+    // answer a write. Unless wait_port is set, the line only goes if memory
+    // takes it in this cycle.
+    bool victim_buffer_write (bool wait_port) {
+        bool sent = true;
+        int n = 0;
+        
+        dmem_dout.read_en = false;
+        dmem_dout.write_en = true;
+        dmem_dout.data_in = victim_buffer_data[0];
+        dmem_dout.write_addr = 0;
+        dmem_dout.write_addr.range(DCACHE_TAG_WIDTH + DCACHE_INDEX_WIDTH + DCACHE_OFFSET_WIDTH - 1, DCACHE_OFFSET_WIDTH) = victim_buffer_addr[0].range(DCACHE_TAG_WIDTH + DCACHE_INDEX_WIDTH, 1);
+        
+        if (wait_port) {
+            dmem_in.Push(dmem_dout);
+        } else {
+            sent = dmem_in.PushNB(dmem_dout);
+        }
+        
+        if (sent) {
+            for (n = 0; n < VICTIM_BUFFER_SIZE - 1; n++) {
+                victim_buffer_addr[n] = victim_buffer_addr[n+1];
+                victim_buffer_data[n] = victim_buffer_data[n+1];
+            }
+            victim_buffer_addr[VICTIM_BUFFER_SIZE - 1] = 0;
+        }
+        return sent;
+    }
+    
+    // On a miss, brings the line back from the write-back buffer if it is there.
+    // It is installed dirty, as memory does not have its data yet. Expects the
+    // set of word_addr to have been looked up.
+    bool victim_buffer_restore (sc_uint < XLEN > word_addr) {
+        sc_uint < DCACHE_LINE > line = 0;
+        bool found = false;
+        int n = 0;
+        
+        for (n = 0; n < VICTIM_BUFFER_SIZE; n++) {
+            if (found) {
+                victim_buffer_addr[n-1] = victim_buffer_addr[n];
+                victim_buffer_data[n-1] = victim_buffer_data[n];
+                victim_buffer_addr[n] = 0;
+            } else if (victim_buffer_addr[n][0] == 1 && victim_buffer_addr[n].range(DCACHE_TAG_WIDTH + DCACHE_INDEX_WIDTH, 1) == word_addr.range(XLEN - 1, DCACHE_OFFSET_WIDTH)) {
+                line = victim_buffer_data[n];
+                victim_buffer_addr[n] = 0;
+                found = true;
+            }
+        }
+        
+        if (found) {
+            dcache_evict();
+            cache_data[0][dcache_way].data = line;
+            dcache_write(false, false);
+        }
+        return found;
+    }
+    
+    // Takes a free MSHR for a miss and requests the line. A load to a line that
+    // is already on its way for a store or a prefetch joins that MSHR instead.
+    // Fails when no MSHR is free or the line is already on its way for a load.
+    // A prefetch only goes if memory takes the request in this cycle. Expects
+    // dcache_address() to have been called with word_addr.
+    bool mshr_allocate (sc_uint < XLEN > word_addr, bool load, sc_uint < 5 > byte_index, bool prefetch) {
+        sc_uint < MSHR_ID_WIDTH > id = 0;
+        sc_uint < MSHR_ID_WIDTH > pending_id = 0;
+        bool found = false;
+        bool pending = false;
+        bool join = false;
+        bool sent = true;
+        int n = 0;
+        
+        for (n = 0; n < MSHR_NUM; n++) {
+            if (mshr_addr[n][0] == 1 && !mshr_words[n].and_reduce() && mshr_addr[n].range(XLEN, DCACHE_OFFSET_WIDTH + 1) == word_addr.range(XLEN - 1, DCACHE_OFFSET_WIDTH)) {
+                pending = true;
+                pending_id = n;
+            }
+            if (mshr_addr[n][0] == 0 && !found) {
+                id = n;
+                found = true;
+            }
+        }
+        
+        if (pending && load && !mshr_load[pending_id]) {
+            id = pending_id;
+            join = true;
+        } else if (!found || pending) {
+            return false;
+        }
+        
+        if (!join) {
+            mshr_addr[id].range(XLEN, 1) = word_addr;
+            mshr_addr[id][0] = 1;
+            mshr_line[id] = 0;
+            mshr_words[id] = 0;
+        }
+        mshr_done[id] = false;
+        mshr_offset[id] = offset;
+        mshr_load[id] = load && input.regwrite == 1 && input.dest_reg != 0;
+        mshr_ld[id] = input.ld;
+        mshr_byte_index[id] = byte_index;
+        mshr_dest[id] = input.dest_reg;
+        mshr_tag[id] = input.tag;
+        mshr_data[id] = 0;
+        mshr_mask[id] = 0;
+        if (load) {
+            store_buffer_forward(word_addr, mshr_data[id], mshr_mask[id]);
+        }
+        
+        if (join) {
+            #ifdef DCACHE_PREFETCH
+            if (mshr_prefetch[id]) {
+                useful_prefetches++;
+            }
+            #endif
+            mshr_prefetch[id] = false;
+            // The word may have arrived already
+            mshr_complete(id);
+            return true;
+        }
+        mshr_prefetch[id] = prefetch;
+        
+        dmem_dout.data_addr = word_addr;
+        dmem_dout.read_en = true;
+        dmem_dout.write_en = false;
+        dmem_dout.id = id;
+        if (prefetch) {
+            sent = dmem_in.PushNB(dmem_dout);
+        } else {
+            dmem_in.Push(dmem_dout);
+        }
+        
+        if (!sent) {
+            mshr_addr[id] = 0;
+        }
+        return sent;
+    }
+    
+    // Takes one word of a line returned by memory. Once all words are in, the
+    // line is installed in the way the replacement policy picks.
+    void mshr_fill (sc_uint < MSHR_ID_WIDTH > id, sc_uint < DCACHE_OFFSET_WIDTH + 1 > word, sc_uint < XLEN > data) {
+        int i = 0;
+        
+        for (i = 0; i < DCACHE_LINE_WORDS; i++) {
+            if (i == word) {
+                mshr_line[id].range(i*XLEN + XLEN - 1, i*XLEN) = data;
+                mshr_words[id][i] = 1;
+            }
+        }
+        mshr_complete(id);
+        
+        if (mshr_words[id].and_reduce()) {
+            dcache_address(mshr_addr[id].range(XLEN, 1));
+            dcache_out = dcache();
+            dcache_evict();
+            cache_data[0][dcache_way].data = mshr_line[id];
+            cache_tag[0][dcache_way].prefetched = mshr_prefetch[id];
+            dcache_write(true, false);
+            mshr_prefetch[id] = false;
+            
+            if (!mshr_load[id]) {
+                mshr_addr[id] = 0;
+            }
+        }
+    }
+    
+    // A waiting load completes as soon as its word is in, without waiting for
+    // the rest of the line. The bytes saved at the miss go on top.
+    void mshr_complete (sc_uint < MSHR_ID_WIDTH > id) {
+        sc_uint < XLEN > word = 0;
+        int i = 0;
+        
+        if (mshr_load[id] && !mshr_done[id] && mshr_words[id][mshr_offset[id]] == 1) {
+            for (i = 0; i < DCACHE_LINE_WORDS; i++) {
+                if (i == mshr_offset[id]) {
+                    word = mshr_line[id].range(i*XLEN + XLEN - 1, i*XLEN);
+                }
+            }
+            for (i = 0; i < XLEN / BYTE; i++) {
+                if (mshr_mask[id][i] == 1) {
+                    word.range(BYTE * i + BYTE - 1, BYTE * i) = mshr_data[id].range(BYTE * i + BYTE - 1, BYTE * i);
+                }
+            }
+            mshr_data[id] = load_extend(mshr_ld[id], word, mshr_byte_index[id]);
+            mshr_done[id] = true;
+        }
+    }
+    
+    #ifdef DCACHE_PREFETCH
+    // Trains the entry of the load/store at pc with its word address. Once the
+    // same stride has been seen RPT_THRESHOLD times in a row, the address
+    // 2^RPT_DISTANCE_WIDTH strides ahead becomes the prefetch candidate.
+    void rpt_update (sc_uint < PC_LEN > pc, sc_uint < XLEN > word_addr) {
+        sc_uint < RPT_INDEX_WIDTH > i = pc.range(RPT_INDEX_WIDTH, 1);
+        sc_uint < XLEN > stride = word_addr - rpt_addr[i];
+        bool steady = false;
+        
+        if (rpt_pc[i] != pc) {
+            rpt_pc[i] = pc;
+            rpt_stride[i] = 0;
+            rpt_confidence[i] = 0;
+        } else if (stride == rpt_stride[i]) {
+            if (rpt_confidence[i] < RPT_CONFIDENCE_MAX) {
+                rpt_confidence[i]++;
+            }
+            steady = (stride != 0 && rpt_confidence[i] >= RPT_THRESHOLD);
+        } else if (rpt_confidence[i] > 0) {
+            rpt_confidence[i]--;
+        } else {
+            rpt_stride[i] = stride;
+        }
+        rpt_addr[i] = word_addr;
+        
+        if (steady) {
+            prefetch_addr = word_addr + (stride << RPT_DISTANCE_WIDTH);
+            prefetch_valid = true;
+        }
+    }
+    
+    // Requests the line of the prefetch candidate unless the D$, the write-back
+    // buffer or an MSHR already has it. The candidate is dropped either way.
+    void prefetch_issue () {
+        bool buffered = false;
+        int n = 0;
+        
+        prefetch_valid = false;
+        if (prefetch_addr >= DCACHE_SIZE) {
+            return;
+        }
+        
+        dcache_address(prefetch_addr);
+        dcache_out = dcache();
+        for (n = 0; n < VICTIM_BUFFER_SIZE; n++) {
+            if (victim_buffer_addr[n][0] == 1 && victim_buffer_addr[n].range(DCACHE_TAG_WIDTH + DCACHE_INDEX_WIDTH, 1) == prefetch_addr.range(XLEN - 1, DCACHE_OFFSET_WIDTH)) {
+                buffered = true;
+            }
+        }
+        
+        if (!dcache_out.hit && !buffered) {
+            mshr_allocate(prefetch_addr, false, 0, true);
+        }
+    }
+    #endif
+    
+    // A line requested by an MSHR is still on its way.
+    bool mshr_outstanding () {
+        bool outstanding = false;
+        int n = 0;
+        
+        for (n = 0; n < MSHR_NUM; n++) {
+            if (mshr_addr[n][0] == 1 && !mshr_words[n].and_reduce()) {
+                outstanding = true;
+            }
+        }
+        return outstanding;
+    }
+    
+    // Waits for every miss in flight. Memory answers in order, so the response
+    // to the next request is the next one to arrive.
+    void mshr_drain () {
+        int n = 0;
+        
+        for (n = 0; n < MSHR_NUM * DCACHE_LINE_WORDS; n++) {
+            if (mshr_outstanding()) {
+                dmem_din = dmem_out.Pop();
+                mshr_fill(dmem_din.id, dmem_din.word, dmem_din.data_out);
+            }
+        }
+    }
+    
+    // Sends one completed load to decode, through writeback. Its MSHR is freed
+    // unless the rest of the line is still on its way.
+    void mshr_report () {
+        bool sent = false;
+        int n = 0;
+        
+        output.late_regwrite = 0;
+        output.late_unit = UNIT_NONE;
+        for (n = 0; n < MSHR_NUM; n++) {
+            if (mshr_addr[n][0] == 1 && mshr_done[n] && !sent) {
+                output.late_regwrite = 1;
+                output.late_regfile_address = mshr_dest[n];
+                output.late_regfile_data = mshr_data[n];
+                output.late_tag = mshr_tag[n];
+                mshr_load[n] = false;
+                mshr_done[n] = false;
+                if (mshr_words[n].and_reduce()) {
+                    mshr_addr[n] = 0;
+                }
+                sent = true;
+            }
+        }
+    }
+    
+    // Extends the loaded bytes of a word as the load type requires. Used for
+    // loads completed by an MSHR.
+    sc_uint < XLEN > load_extend (sc_uint < 3 > ld, sc_uint < XLEN > word, sc_uint < 5 > byte_index) {
+        sc_uint < XLEN > result = 0;
+        sc_uint < 5 > halfword_index = byte_index & 16;
+        sc_uint < BYTE > db = 0;
+        sc_uint < 2 * BYTE > dh = 0;
+        
+        switch (ld) {
+        case LB_LOAD:
+            db = word.range(BYTE + byte_index - 1, byte_index);
+            result = ext_sign_byte(db);
+            break;
+        case LH_LOAD:
+            dh = word.range(2 * BYTE + halfword_index - 1, halfword_index);
+            result = ext_sign_halfword(dh);
+            break;
+        case LBU_LOAD:
+            db = word.range(BYTE + byte_index - 1, byte_index);
+            result = ext_unsign_byte(db);
+            break;
+        case LHU_LOAD:
+            dh = word.range(2 * BYTE + halfword_index - 1, halfword_index);
+            result = ext_unsign_halfword(dh);
+            break;
+        default:
+            result = word; // LW_LOAD
+            break;
+        }
+        return result;
+    }
+    
+    // Overlays the bytes of queued stores to the same word on data and marks them
+    // in mask. Entries are visited oldest first, so the youngest store wins.
+    void store_buffer_forward (sc_uint < XLEN > word_addr, sc_uint < XLEN > &data, sc_uint < XLEN / BYTE > &mask) {
+        int n = 0;
+        int i = 0;
+        
+        for (n = 0; n < STORE_BUFFER_SIZE; n++) {
+            if (store_buffer_addr[n][0] == 1 && store_buffer_addr[n].range(XLEN, 1) == word_addr) {
+                for (i = 0; i < XLEN / BYTE; i++) {
+                    if (store_buffer_mask[n][i] == 1) {
+                        data.range(BYTE * i + BYTE - 1, BYTE * i) = store_buffer_data[n].range(BYTE * i + BYTE - 1, BYTE * i);
+                        mask[i] = 1;
+                    }
+                }
+            }
+        }
+    }
+    
+    #ifdef ATOMIC
+    // New value of the word an atomic read-modify-write found in old.
+    sc_uint < XLEN > amo_compute (sc_uint < 5 > amo, sc_uint < XLEN > old, sc_uint < XLEN > operand) {
+        switch (amo) {
+        case AMO_ADD:
+            return old + operand;
+        case AMO_XOR:
+            return old ^ operand;
+        case AMO_OR:
+            return old | operand;
+        case AMO_AND:
+            return old & operand;
+        case AMO_MIN:
+            return ((sc_int < XLEN >) old < (sc_int < XLEN >) operand) ? old : operand;
+        case AMO_MAX:
+            return ((sc_int < XLEN >) old < (sc_int < XLEN >) operand) ? operand : old;
+        case AMO_MINU:
+            return (old < operand) ? old : operand;
+        case AMO_MAXU:
+            return (old < operand) ? operand : old;
+        default:
+            return operand; // AMO_SWAP, AMO_SC
+        }
+    }
+    
+    // Puts the new value of an atomic into the looked up line, which dcache_write()
+    // then stores dirty. Stores to the word still queued are older and already part
+    // of old, so they take the new value too. old becomes the result for rd.
+    void amo_write (sc_uint < XLEN > &old) {
+        sc_uint < XLEN > value = amo_compute(input.amo, old, (sc_uint < XLEN >) input.mem_datain);
+        int n = 0;
+        
+        #pragma unroll yes
+        for (int i = 0; i < DATA_WIDTH; i++) {
+            int index_word = offset*DATA_WIDTH + i;
+            dmem_data[index_word] = value[i];
+        }
+        cache_data[0][dcache_way].data = dmem_data;
+        
+        for (n = 0; n < STORE_BUFFER_SIZE; n++) {
+            if (store_buffer_addr[n][0] == 1 && store_buffer_addr[n].range(XLEN, 1) == (input.alu_res >> 2)) {
+                store_buffer_data[n] = value;
+            }
+        }
+        
+        if (input.amo == AMO_SC) {
+            old = 0;
+        }
+    }
+    #endif
+    
+    // Removes the entry that was written into the D$ and queues the new store.
+    // A store never finds the buffer full: when it is, the oldest entry reaches
+    // the D$ in the same cycle, waiting for its line if needed.
+    void store_buffer_update (bool drain, bool enqueue, sc_uint < XLEN > word_addr, sc_uint < XLEN > data, sc_uint < XLEN / BYTE > mask) {
+        int n = 0;
+        bool placed = false;
+        
+        if (drain) {
+            for (n = 0; n < STORE_BUFFER_SIZE - 1; n++) {
+                store_buffer_addr[n] = store_buffer_addr[n+1];
+                store_buffer_data[n] = store_buffer_data[n+1];
+                store_buffer_mask[n] = store_buffer_mask[n+1];
+            }
+            store_buffer_addr[STORE_BUFFER_SIZE - 1] = 0;
+        }
+        
+        if (enqueue) {
+            for (n = 0; n < STORE_BUFFER_SIZE; n++) {
+                if (store_buffer_addr[n][0] == 0 && !placed) {
+                    store_buffer_addr[n].range(XLEN, 1) = word_addr;
+                    store_buffer_addr[n][0] = 1;
+                    store_buffer_data[n] = data;
+                    store_buffer_mask[n] = mask;
+                    placed = true;
+                }
+            }
+        }
+    }
+
+};
+
+#endif
@@ -0,0 +1,155 @@
+/*	
+	@author VLSI Lab, EE dept., Democritus University of Thrace
+
+	@brief 
+	Header file for the multiplier unit.
+	MUL, MULH, MULHSU and MULHU go through MUL_STAGES pipeline stages, each
+	adding the partial product of one MUL_CHUNK-bit chunk of the second
+	operand, so a multiplication no longer has to fit in the execute cycle.
+	A new multiplication is taken every cycle. The result is sent to
+	writeback, which passes it to decode as a late register write.
+
+*/
+
+#ifndef __MULTIPLIER__H
+#define __MULTIPLIER__H
+
+#ifndef NDEBUG
+    #include <iostream>
+    #define DPRINT(msg) std::cout << msg;
+#endif
+
+#include "drim4hls_datatypes.h"
+#include "defines.h"
+#include "globals.h"
+
+#include <mc_connections.h>
+
+SC_MODULE(multiplier) {
+    // Clock and reset signals
+    sc_in < bool > CCS_INIT_S1(clk);
+    sc_in < bool > CCS_INIT_S1(rst);
+    
+    // FlexChannel initiators
+    Connections::In < mul_in_t > CCS_INIT_S1(din);
+    Connections::Out < unit_out_t > CCS_INIT_S1(dout);
+    
+    // Member variables
+    mul_in_t input;
+    unit_out_t output;
+    
+    // Pipeline registers. Stage n holds the sum of the partial products of
+    // chunks 0 to n of b.
+    bool stage_valid[MUL_STAGES];
+    sc_uint < 2 * XLEN > stage_acc[MUL_STAGES];
+    sc_uint < XLEN > stage_a[MUL_STAGES];
+    sc_uint < XLEN > stage_b[MUL_STAGES];
+    bool stage_sign_a[MUL_STAGES];
+    bool stage_sign_b[MUL_STAGES];
+    bool stage_high[MUL_STAGES];
+    sc_uint < REG_ADDR > stage_dest[MUL_STAGES];
+    sc_uint < TAG_WIDTH > stage_tag[MUL_STAGES];
+    
+    // Constructor
+    SC_CTOR(multiplier): din("din"), dout("dout"), clk("clk"), rst("rst") {
+        SC_THREAD(multiplier_th);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst, false);
+    }
+
+    void multiplier_th(void) {
+        MULTIPLIER_RST: {
+            din.Reset();
+            dout.Reset();
+            
+            for (int n = 0; n < MUL_STAGES; n++) {
+                stage_valid[n] = false;
+                stage_acc[n] = 0;
+                stage_a[n] = 0;
+                stage_b[n] = 0;
+                stage_sign_a[n] = false;
+                stage_sign_b[n] = false;
+                stage_high[n] = false;
+                stage_dest[n] = 0;
+                stage_tag[n] = 0;
+            }
+            
+            wait();
+        }
+        
+        #pragma hls_pipeline_init_interval 1
+        #pragma pipeline_stall_mode flush
+        MULTIPLIER_BODY: while (true) {
+            // Decode keeps at most MUL_INFLIGHT multiplications in flight, as many
+            // as the result buffer holds, so this never waits.
+            if (stage_valid[MUL_STAGES - 1]) {
+                output.result = mul_result();
+                output.dest_reg = stage_dest[MUL_STAGES - 1];
+                output.tag = stage_tag[MUL_STAGES - 1];
+                dout.Push(output);
+                
+                #ifndef __SYNTHESIS__
+                DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << std::hex << "result= " << output.result << endl);
+                DPRINT("@" << sc_time_stamp() << "\t" << name() << "\t" << "tag= " << output.tag << endl);
+                #endif
+            }
+            
+            stage_advance();
+            
+            stage_valid[0] = din.PopNB(input);
+            stage_acc[0] = partial_product(input.a, input.b, 0);
+            stage_a[0] = input.a;
+            stage_b[0] = input.b;
+            stage_sign_a[0] = input.sign_a;
+            stage_sign_b[0] = input.sign_b;
+            stage_high[0] = input.high;
+            stage_dest[0] = input.dest_reg;
+            stage_tag[0] = input.tag;
+            
+            wait();
+        }
+    }
+
+    /* Support functions */
+
+    // Product of a and one chunk of b, shifted to the place of the chunk.
+    sc_uint < 2 * XLEN > partial_product(sc_uint < XLEN > a, sc_uint < XLEN > b, int chunk) {
+        sc_uint < MUL_CHUNK > digit = b.range(chunk*MUL_CHUNK + MUL_CHUNK - 1, chunk*MUL_CHUNK);
+        sc_uint < 2 * XLEN > product = (sc_uint < XLEN + MUL_CHUNK >) (a * digit);
+        
+        return product << (chunk*MUL_CHUNK);
+    }
+    
+    // Every multiplication moves one stage on and adds the next chunk.
+    void stage_advance() {
+        for (int n = MUL_STAGES - 1; n > 0; n--) {
+            stage_valid[n] = stage_valid[n-1];
+            stage_acc[n] = stage_acc[n-1] + partial_product(stage_a[n-1], stage_b[n-1], n);
+            stage_a[n] = stage_a[n-1];
+            stage_b[n] = stage_b[n-1];
+            stage_sign_a[n] = stage_sign_a[n-1];
+            stage_sign_b[n] = stage_sign_b[n-1];
+            stage_high[n] = stage_high[n-1];
+            stage_dest[n] = stage_dest[n-1];
+            stage_tag[n] = stage_tag[n-1];
+        }
+    }
+    
+    // The stages multiply unsigned. A negative signed operand stands for itself
+    // plus 2^XLEN, so the other operand is taken off the upper half once.
+    sc_uint < XLEN > mul_result() {
+        sc_uint < 2 * XLEN > product = stage_acc[MUL_STAGES - 1];
+        sc_uint < XLEN > high = product.range(2 * XLEN - 1, XLEN);
+        
+        if (stage_sign_a[MUL_STAGES - 1] && stage_a[MUL_STAGES - 1][XLEN - 1] == 1) {
+            high = high - stage_b[MUL_STAGES - 1];
+        }
+        if (stage_sign_b[MUL_STAGES - 1] && stage_b[MUL_STAGES - 1][XLEN - 1] == 1) {
+            high = high - stage_a[MUL_STAGES - 1];
+        }
+        
+        return (stage_high[MUL_STAGES - 1]) ? high : (sc_uint < XLEN >) product.range(XLEN - 1, 0);
+    }
+};
+
+#endif // end __MULTIPLIER__H
@@ -0,0 +1,76 @@
+/*	
+	@author VLSI Lab, EE dept., Democritus University of Thrace
+
+	@brief 
+	Header file for the register file of decode.
+	Every write port has its own copy of the registers, and a live-value
+	table keeps which copy was written last for each register, so that the
+	copies need a single write port each. Reads are spread over
+	REGFILE_BANKS banks of REGFILE_BANK_READS ports. Decode asks whether
+	the reads of the ALU lane fit next to those of the first instruction,
+	and holds the second instruction back otherwise.
+
+*/
+
+#ifndef __REGFILE__H
+#define __REGFILE__H
+
+#include "drim4hls_datatypes.h"
+#include "defines.h"
+#include "globals.h"
+
+#define REGFILE_WP_WB   0 // Writeback
+#define REGFILE_WP_LATE 1 // Late load or unit result
+#define REGFILE_WP_WB_1 2 // Writeback of the ALU lane
+
+class regfile_t {
+  public:
+    sc_uint < XLEN > copy[REGFILE_WRITE_PORTS][REG_NUM];
+    sc_uint < REGFILE_LVT_WIDTH > lvt[REG_NUM]; // Copy holding the value of each register
+    sc_uint < XLEN > conflicts[REGFILE_BANKS]; // Reads refused by each bank, to size the ports
+    
+    void reset() {
+        for (int r = 0; r < REG_NUM; r++) {
+            lvt[r] = 0;
+        }
+        for (int b = 0; b < REGFILE_BANKS; b++) {
+            conflicts[b] = 0;
+        }
+    }
+    
+    sc_uint < XLEN > read(sc_uint < REG_ADDR > addr) {
+        sc_uint < XLEN > data = copy[0][addr];
+        for (int p = 1; p < REGFILE_WRITE_PORTS; p++) {
+            if (lvt[addr] == p) {
+                data = copy[p][addr];
+            }
+        }
+        return data;
+    }
+    
+    void write(int port, sc_uint < REG_ADDR > addr, sc_uint < XLEN > data) {
+        copy[port][addr] = data;
+        lvt[addr] = port;
+    }
+    
+    // True if the enabled reads find a free port in their bank. x0 is never
+    // written and needs no port. A refused read counts as a conflict of its bank.
+    bool reads_fit(sc_uint < REG_ADDR > addr[REGFILE_READS], bool enable[REGFILE_READS]) {
+        bool fit = true;
+        for (int b = 0; b < REGFILE_BANKS; b++) {
+            int reads = 0;
+            for (int i = 0; i < REGFILE_READS; i++) {
+                if (enable[i] && addr[i] != 0 && addr[i] % REGFILE_BANKS == b) {
+                    reads++;
+                }
+            }
+            if (reads > REGFILE_BANK_READS) {
+                conflicts[b]++;
+                fit = false;
+            }
+        }
+        return fit;
+    }
+};
+
+#endif
@@ -36,8 +36,8 @@ class Top: public sc_module {
     Connections::Combinational < imem_out_t > CCS_INIT_S1(imem2de_ch);
     Connections::Combinational < imem_in_t > CCS_INIT_S1(fe2imem_ch);
 
-    Connections::Combinational < dmem_out_t > CCS_INIT_S1(dmem2wb_ch);
-    Connections::Combinational < dmem_in_t > CCS_INIT_S1(wb2dmem_ch);
+    Connections::Buffer < dmem_out_t, MSHR_NUM * DCACHE_LINE_WORDS > CCS_INIT_S1(dmem2mem_ch); // Holds the responses to the misses in flight
+    Connections::Combinational < dmem_in_t > CCS_INIT_S1(mem2dmem_ch);
 
     sc_uint < XLEN > imem[ICACHE_SIZE];
 
@@ -74,8 +74,8 @@ class Top: public sc_module {
 
         m_dut.imem2de_data(imem2de_ch);
         m_dut.fe2imem_data(fe2imem_ch);
-        m_dut.dmem2wb_data(dmem2wb_ch);
-        m_dut.wb2dmem_data(wb2dmem_ch);
+        m_dut.dmem2mem_data(dmem2mem_ch);
+        m_dut.mem2dmem_data(mem2dmem_ch);
 
         SC_CTHREAD(run, clk);
 
@@ -102,36 +102,43 @@ class Top: public sc_module {
 			std::cout << "fetch instr " << endl;
 			
 			unsigned int offset_lenght = pow(2 , ICACHE_OFFSET_WIDTH);
-			            
+			unsigned int first = 0;
+			if (ICACHE_OFFSET_WIDTH) {
+				first = addr.range(ICACHE_OFFSET_WIDTH - 1, 0);
+			}
+			
+            unsigned int random_stalls = 1;
+            wait(random_stalls);
+			
+			// One word per cycle, the requested word first and then the rest
+			// of the line, wrapping around.
             for (int i = 0; i < offset_lenght; i++) {
+				unsigned int word = (first + i) % offset_lenght;
 				if (ICACHE_OFFSET_WIDTH) {
-					addr.range(ICACHE_OFFSET_WIDTH - 1, 0) = (sc_uint < ICACHE_OFFSET_WIDTH >) i;                        
+					addr.range(ICACHE_OFFSET_WIDTH - 1, 0) = (sc_uint < ICACHE_OFFSET_WIDTH >) word;                        
                 }
 				std::cout << "imem addr= " << addr << endl;
 
-                imem_dout.instr_data.range(i*XLEN + XLEN -1, i*XLEN) = imem[addr];
+                imem_dout.instr_data = imem[addr];
+                imem_dout.word = word;
                 std::cout << "imem[" << addr << "]=" << imem[addr] << endl;
+                
+                imem2de_ch.Push(imem_dout);
+                wait();
 			}
-
-			
-            unsigned int random_stalls = 1;
-            wait(random_stalls);
-
-            imem2de_ch.Push(imem_dout);
-            wait();
         }
 
     }
 
     void dmemory_th() {
         DMEM_RST: {
-            wb2dmem_ch.ResetRead();
-            dmem2wb_ch.ResetWrite();
+            mem2dmem_ch.ResetRead();
+            dmem2mem_ch.ResetWrite();
 			wait_stalls = 0;
             wait();
         }
         DMEM_BODY: while (true) {
-            dmem_din = wb2dmem_ch.Pop();
+            dmem_din = mem2dmem_ch.Pop();
 
 			sc_uint < XLEN > addr = dmem_din.data_addr.to_uint();
 			sc_uint < XLEN > write_addr = dmem_din.write_addr.to_uint();
@@ -146,18 +153,31 @@ class Top: public sc_module {
              
             if (dmem_din.read_en) {
 				std::cout << "dmem read" << endl;
+                dmem_dout.id = dmem_din.id;
+                
+                unsigned int first = 0;
+                if (DCACHE_OFFSET_WIDTH) {
+                    first = addr.range(DCACHE_OFFSET_WIDTH - 1, 0);
+                }
 
+                // One word per cycle, the requested word first and then the rest
+                // of the line, wrapping around.
                 for (int i = 0; i < offset_lenght; i++) {
+                    unsigned int word = (first + i) % offset_lenght;
                     if (DCACHE_OFFSET_WIDTH) {
-                        addr.range(DCACHE_OFFSET_WIDTH - 1, 0) = (sc_uint < DCACHE_OFFSET_WIDTH >) i;                        
+                        addr.range(DCACHE_OFFSET_WIDTH - 1, 0) = (sc_uint < DCACHE_OFFSET_WIDTH >) word;                        
                     }
                     std::cout << "dmem addr= " << addr << endl;
 
-                    dmem_dout.data_out.range(i*XLEN + XLEN -1, i*XLEN) = dmem[addr];
+                    dmem_dout.data_out = dmem[addr];
+                    dmem_dout.word = word;
                     std::cout << "dmem[" << addr << "]=" << dmem[addr] << endl;
+                    
+                    dmem2mem_ch.Push(dmem_dout);
+                    if (i < offset_lenght - 1) {
+                        wait();
+                    }
                 }
-                
-                dmem2wb_ch.Push(dmem_dout);
             } 
             if (dmem_din.write_en) {
 				std::cout << "dmem write" << endl;